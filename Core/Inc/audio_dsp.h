@@ -0,0 +1,29 @@
+#ifndef AUDIO_DSP_H
+#define AUDIO_DSP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "dsp_vbass.h"
+#include "dsp_width.h"
+#include "dsp_comp.h"
+#include "dsp_align.h"
+#include "dsp_hrtf.h"
+#include "dsp_peq.h"
+
+#define AUDIO_DSP_S16_SCALE  (1.0f / 32768.0f)   // 16-bit sample -> float full scale
+
+// Firmware DSP chain, free of HAL dependencies so the host build runs the
+// exact same code block by block (see DSP_Host/)
+
+// Function Prototypes
+void audio_dsp_init(float fs);
+void audio_dsp_process(float* left, float* right, uint32_t frames);
+void audio_dsp_to_s16(const float* left, const float* right, int16_t* out, uint32_t frames);
+dsp_vbass_t* audio_dsp_vbass(void);
+dsp_width_t* audio_dsp_width(void);
+dsp_comp_t*  audio_dsp_comp(void);
+dsp_align_t* audio_dsp_align(void);
+dsp_hrtf_t*  audio_dsp_hrtf(void);
+dsp_peq_t*   audio_dsp_peq(void);
+
+#endif // AUDIO_DSP_H
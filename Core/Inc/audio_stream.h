@@ -0,0 +1,23 @@
+#ifndef AUDIO_STREAM_H
+#define AUDIO_STREAM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "dsp_bank.h"
+
+// Stream format (USB -> MCU -> I2S)
+#define AUDIO_STREAM_FS            48000U // Must match USBD_AUDIO_FREQ
+#define AUDIO_STREAM_CHANNELS      2U
+#define AUDIO_STREAM_BLOCK_FRAMES  48U    // Frames processed per DMA half-block (1 ms at 48 kHz)
+#define AUDIO_STREAM_FIFO_FRAMES   512U   // USB -> I2S elastic buffer (power of two)
+
+// Function Prototypes
+void audio_stream_init(void);
+void audio_stream_start(void);
+void audio_stream_stop(void);
+void audio_stream_usb_rx(const uint8_t* pbuf, uint32_t size);
+bool audio_stream_is_running(void);
+bool audio_stream_pipeline_sync(void);
+bool audio_stream_bank_sync(dsp_bank_t* bank);
+
+#endif // AUDIO_STREAM_H
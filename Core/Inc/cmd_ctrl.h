@@ -18,6 +18,7 @@ void ctrl_init(void);
 uint8_t ctrl_parse_cmd(char* line, char* cmd_name, uint8_t cmd_name_len, char* args[], uint16_t* arg_count);
 uint8_t ctrl_execute_cmd(char* cmd_name, char* args[], int arg_count);
 void ctrl_poll(void);
+void ctrl_tx_write(const char* p, uint32_t len);
 
 
 
@@ -0,0 +1,53 @@
+#ifndef DSP_ALIGN_H
+#define DSP_ALIGN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "dsp_bank.h"
+#include "dsp_smooth.h"
+
+// Parameter ranges
+#define DSP_ALIGN_TRIM_MIN_DB10   -120   // Gain trim in 0.1 dB steps
+#define DSP_ALIGN_TRIM_MAX_DB10   60
+#define DSP_ALIGN_MAX_DELAY_US    1000U
+#define DSP_ALIGN_LINE_LEN        64U    // Per channel, power of two > 1 ms at 48 kHz + 3 taps
+#define DSP_ALIGN_SMOOTH_MS       10.0f  // Gain, polarity and delay glide
+
+// Automation parameters (dsp_align_set_param)
+#define DSP_ALIGN_PARAM_TRIM_L    0U     // Trim in dB, keeps the polarity
+#define DSP_ALIGN_PARAM_TRIM_R    1U
+#define DSP_ALIGN_PARAM_DELAY_L   2U     // Delay in us
+#define DSP_ALIGN_PARAM_DELAY_R   3U
+
+// Coefficient bank, written by the main loop and swapped at a block boundary
+typedef struct {
+    float gain[2];      // Linear trim, negative when the polarity is inverted
+    float delay[2];     // Delay in samples
+} dsp_align_coef_t;
+
+// Per-channel balance, polarity and fractional delay
+//
+// Each channel is written into a short circular line and read back with a
+// 4-point Lagrange interpolator at the (smoothed) fractional delay, then
+// scaled by its signed trim gain, both channels in one pass. Polarity
+// changes glide through zero with the gain so they do not click.
+typedef struct {
+    float fs;
+    dsp_align_coef_t coef[2];
+    dsp_bank_t bank;
+    dsp_override_t auto_gain[2];    // Automation, applied on top of the active bank
+    dsp_override_t auto_delay[2];
+
+    dsp_smooth_t gain[2];
+    dsp_smooth_t delay[2];
+    float line[2][DSP_ALIGN_LINE_LEN];
+    uint32_t pos;
+} dsp_align_t;
+
+// Function Prototypes
+void dsp_align_init(dsp_align_t* a, float fs);
+bool dsp_align_set(dsp_align_t* a, uint8_t channel, int16_t trim_db10, bool invert, uint16_t delay_us);
+bool dsp_align_set_param(dsp_align_t* a, uint8_t param, float value);
+void dsp_align_process(dsp_align_t* a, float* left, float* right, uint32_t frames);
+
+#endif // DSP_ALIGN_H
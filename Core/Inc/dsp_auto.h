@@ -0,0 +1,38 @@
+#ifndef DSP_AUTO_H
+#define DSP_AUTO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define DSP_AUTO_QUEUE_LEN     32U    // Power of two
+#define DSP_AUTO_PARAM_BYPASS  255U   // Any stage: value != 0 bypasses it (cross-faded like 'dsp bypass')
+
+// Scheduled parameter change
+//
+// frame is an absolute index into the stream entering the DSP chain (see
+// dsp_pipeline_frame()); it wraps after about 24 h at 48 kHz and is compared
+// with a signed difference, so events must lie less than half that ahead.
+typedef struct {
+    uint32_t frame;
+    uint8_t stage;      // Stage index in the registry
+    uint8_t param;      // Stage parameter id, or DSP_AUTO_PARAM_BYPASS
+    float value;
+} dsp_auto_event_t;
+
+// Applies one due event in the audio path, false if the stage rejected it
+typedef bool (*dsp_auto_apply_fn_t)(const dsp_auto_event_t* ev);
+
+// Function Prototypes
+
+// Main loop
+void     dsp_auto_init(void);
+bool     dsp_auto_push(const dsp_auto_event_t* ev);
+void     dsp_auto_clear(void);
+uint32_t dsp_auto_queued(void);
+uint32_t dsp_auto_late(void);
+uint32_t dsp_auto_rejected(void);
+
+// Audio path
+uint32_t dsp_auto_run(uint32_t now, uint32_t frames, dsp_auto_apply_fn_t apply);
+
+#endif // DSP_AUTO_H
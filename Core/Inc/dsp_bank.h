@@ -0,0 +1,107 @@
+#ifndef DSP_BANK_H
+#define DSP_BANK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Double-buffered coefficient bank index
+//
+// A stage keeps two copies of its coefficient set. The audio path only reads
+// bank[active]; the main loop fills bank[active ^ 1] and publishes it by
+// writing next. The audio path adopts it at its next block boundary with a
+// single byte store, so it never sees a half-written set. Filter state lives
+// outside the banks and carries over the swap.
+//
+// Automation runs in the audio path and never writes a bank: it sets a
+// dsp_override_t owned by the stage, which the stage applies on top of
+// bank[active].
+typedef struct {
+    volatile uint8_t active;   // Bank read by the audio path
+    volatile uint8_t next;     // Bank published by the main loop
+} dsp_bank_t;
+
+/**
+ * @brief Reset to bank 0 with nothing pending
+ */
+static inline void dsp_bank_init(dsp_bank_t* b)
+{
+    b->active = 0;
+    b->next = 0;
+}
+
+/**
+ * @brief true while a published bank has not been adopted by the audio path
+ */
+static inline bool dsp_bank_pending(const dsp_bank_t* b)
+{
+    return b->next != b->active;
+}
+
+/**
+ * @brief Bank the main loop may write, only valid while nothing is pending
+ */
+static inline uint8_t dsp_bank_staging(const dsp_bank_t* b)
+{
+    return b->active ^ 1U;
+}
+
+/**
+ * @brief Publish the staging bank (main loop)
+ */
+static inline void dsp_bank_publish(dsp_bank_t* b)
+{
+    b->next = b->active ^ 1U;
+}
+
+/**
+ * @brief Adopt the published bank (audio path at a block boundary, or main loop while stopped)
+ * @return true if the active bank changed
+ */
+static inline bool dsp_bank_acquire(dsp_bank_t* b)
+{
+    uint8_t next = b->next;
+    if (next == b->active) {
+        return false;
+    }
+    b->active = next;
+    return true;
+}
+
+// Audio-owned value applied on top of one bank parameter
+//
+// Set by automation in the audio path. It holds until the main loop publishes
+// a different value for that parameter, so a later setter wins over stale
+// automation and automation is not lost at the next flip.
+typedef struct {
+    bool on;
+    float base;    // Bank value the override was set against
+    float value;
+} dsp_override_t;
+
+/**
+ * @brief Override a parameter (audio path)
+ * @param o Override
+ * @param bank_value Current value of the parameter in bank[active]
+ * @param value Automated value
+ */
+static inline void dsp_override_set(dsp_override_t* o, float bank_value, float value)
+{
+    o->on = true;
+    o->base = bank_value;
+    o->value = value;
+}
+
+/**
+ * @brief Effective value of a parameter (audio path)
+ * @param o Override, dropped once the bank value differs from its base
+ * @param bank_value Current value of the parameter in bank[active]
+ */
+static inline float dsp_override_apply(dsp_override_t* o, float bank_value)
+{
+    if (o->on && bank_value != o->base) {
+        o->on = false;
+    }
+    return o->on ? o->value : bank_value;
+}
+
+#endif // DSP_BANK_H
@@ -0,0 +1,13 @@
+#ifndef DSP_BENCH_H
+#define DSP_BENCH_H
+
+#include <stdint.h>
+
+#define DSP_BENCH_MAX_FRAMES   256U
+#define DSP_BENCH_DEFAULT_REPS 32U
+#define DSP_BENCH_MAX_REPS     1000U
+
+// Function Prototypes
+void dsp_bench_run(uint32_t reps);
+
+#endif // DSP_BENCH_H
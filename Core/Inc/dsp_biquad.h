@@ -0,0 +1,40 @@
+#ifndef DSP_BIQUAD_H
+#define DSP_BIQUAD_H
+
+#include <stdint.h>
+
+#define DSP_BIQUAD_Q_BUTTERWORTH  0.70710678f
+
+// Normalized coefficients (a0 = 1), y = b0*x + b1*x1 + b2*x2 - a1*y1 - a2*y2
+typedef struct {
+    float b0;
+    float b1;
+    float b2;
+    float a1;
+    float a2;
+} dsp_biquad_coef_t;
+
+// Transposed direct form II state
+typedef struct {
+    float z1;
+    float z2;
+} dsp_biquad_state_t;
+
+// Function Prototypes
+void dsp_biquad_design_lpf(dsp_biquad_coef_t* c, float fs, float f0, float q);
+void dsp_biquad_design_hpf(dsp_biquad_coef_t* c, float fs, float f0, float q);
+void dsp_biquad_reset(dsp_biquad_state_t* s);
+void dsp_biquad_process(const dsp_biquad_coef_t* c, dsp_biquad_state_t* s, float* buf, uint32_t n);
+
+/**
+ * @brief Run one sample through a biquad section
+ */
+static inline float dsp_biquad_tick(const dsp_biquad_coef_t* c, dsp_biquad_state_t* s, float x)
+{
+    float y = c->b0 * x + s->z1;
+    s->z1 = c->b1 * x - c->a1 * y + s->z2;
+    s->z2 = c->b2 * x - c->a2 * y;
+    return y;
+}
+
+#endif // DSP_BIQUAD_H
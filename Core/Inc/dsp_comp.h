@@ -0,0 +1,68 @@
+#ifndef DSP_COMP_H
+#define DSP_COMP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "dsp_bank.h"
+#include "dsp_smooth.h"
+
+// Parameter ranges
+#define DSP_COMP_THRESH_MIN_DB    -60.0f
+#define DSP_COMP_THRESH_MAX_DB    0.0f
+#define DSP_COMP_RATIO_MIN        1.0f
+#define DSP_COMP_RATIO_MAX        20.0f
+#define DSP_COMP_KNEE_MAX_DB      24.0f
+#define DSP_COMP_ATTACK_MIN_MS    0.1f
+#define DSP_COMP_ATTACK_MAX_MS    200.0f
+#define DSP_COMP_RELEASE_MIN_MS   5.0f
+#define DSP_COMP_RELEASE_MAX_MS   2000.0f
+#define DSP_COMP_MAKEUP_MAX_DB    24.0f
+#define DSP_COMP_SMOOTH_MS        10.0f  // Make-up gain glide
+
+// Automation parameters (dsp_comp_set_param)
+#define DSP_COMP_PARAM_THRESH_DB  0U
+#define DSP_COMP_PARAM_MAKEUP_DB  1U     // Only while enabled
+
+// Coefficient bank, written by the main loop and swapped at a block boundary
+typedef struct {
+    bool enable;
+    float thresh_db;
+    float knee_db;
+    float slope;        // 1/ratio - 1 (<= 0)
+    float attack_a;     // One-pole coefficients of the gain envelope
+    float release_a;
+    float makeup_db;
+} dsp_comp_coef_t;
+
+// Stereo-linked feed-forward compressor / AGC
+//
+// The detector takes max(|L|, |R|) to dB, a soft-knee gain computer gives
+// the static gain reduction and an attack/release one-pole smooths it in
+// the log domain. Make-up gain is added in dB so one exp2 per sample turns
+// the result back into a linear gain applied to both channels. log2/exp2
+// use the bit-level approximations from dsp_fastmath.h.
+typedef struct {
+    float fs;
+    dsp_comp_coef_t coef[2];
+    dsp_bank_t bank;
+    dsp_override_t auto_thresh;    // Automation, applied on top of the active bank
+    dsp_override_t auto_makeup;
+
+    float env_db;       // Smoothed gain reduction (<= 0)
+    dsp_smooth_t makeup_db;
+
+    // Telemetry, written by the audio path
+    volatile float gr_db;         // Gain reduction at the end of the last block
+    volatile float gr_peak_db;    // Deepest gain reduction since the last read
+    volatile bool gr_peak_reset;  // Requested by the reader, applied by the audio path
+} dsp_comp_t;
+
+// Function Prototypes
+void dsp_comp_init(dsp_comp_t* c, float fs);
+bool dsp_comp_set(dsp_comp_t* c, bool enable, float thresh_db, float ratio, float knee_db,
+                  float attack_ms, float release_ms, float makeup_db);
+bool dsp_comp_set_param(dsp_comp_t* c, uint8_t param, float value);
+void dsp_comp_process(dsp_comp_t* c, float* left, float* right, uint32_t frames);
+void dsp_comp_read_gr(dsp_comp_t* c, float* gr_db, float* gr_peak_db);
+
+#endif // DSP_COMP_H
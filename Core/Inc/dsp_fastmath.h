@@ -0,0 +1,66 @@
+#ifndef DSP_FASTMATH_H
+#define DSP_FASTMATH_H
+
+#include <stdint.h>
+
+#define DSP_DB_PER_LOG2  6.02059991f   // 20 * log10(2)
+
+// Bit-level float views for the approximations below
+typedef union {
+    float f;
+    uint32_t u;
+} dsp_f32_bits_t;
+
+/**
+ * @brief log2(x) for x > 0, max error about 0.005 (0.03 dB)
+ *
+ * Exponent from the float bits, quadratic fit of log2 over the mantissa in [1, 2).
+ */
+static inline float dsp_fast_log2(float x)
+{
+    dsp_f32_bits_t v = { x };
+    float e = (float)(int32_t)((v.u >> 23) & 0xFFU) - 128.0f;
+    v.u = (v.u & 0x007FFFFFU) | 0x3F800000U;
+    return e + (-0.34484843f * v.f + 2.02466578f) * v.f - 0.67487759f;
+}
+
+/**
+ * @brief 2^p, relative error below 1.5e-4, saturates to 0 below -126
+ *
+ * Integer part goes to the exponent bits, cubic fit of 2^z for the fraction.
+ */
+static inline float dsp_fast_exp2(float p)
+{
+    if (p < -126.0f) {
+        return 0.0f;
+    }
+    if (p > 126.0f) {
+        p = 126.0f;
+    }
+    int32_t w = (int32_t)p;
+    if (p < (float)w) {
+        w--;
+    }
+    float z = p - (float)w;
+    dsp_f32_bits_t v;
+    v.u = (uint32_t)(w + 127) << 23;
+    return v.f * (1.0f + z * (0.69583356f + z * (0.22606716f + z * 0.07809950f)));
+}
+
+/**
+ * @brief Amplitude in dB, via dsp_fast_log2
+ */
+static inline float dsp_fast_lin_to_db(float x)
+{
+    return DSP_DB_PER_LOG2 * dsp_fast_log2(x);
+}
+
+/**
+ * @brief dB to amplitude, via dsp_fast_exp2
+ */
+static inline float dsp_fast_db_to_lin(float db)
+{
+    return dsp_fast_exp2(db * (1.0f / DSP_DB_PER_LOG2));
+}
+
+#endif // DSP_FASTMATH_H
@@ -0,0 +1,65 @@
+#ifndef DSP_HRTF_H
+#define DSP_HRTF_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "dsp_bank.h"
+#include "dsp_smooth.h"
+
+#define DSP_HRTF_TAPS       64U     // Filter length, 1.33 ms at 48 kHz (power of two)
+#define DSP_HRTF_ONSET      4U      // Ipsilateral arrival in samples, the latency of the stage
+#define DSP_HRTF_SET_COUNT  3U
+#define DSP_HRTF_OFF        -1
+#define DSP_HRTF_FADE_MS    5.0f    // Set changes fade to dry and back in
+
+// Automation parameters (dsp_hrtf_set_param)
+#define DSP_HRTF_PARAM_SET  0U      // Set index, or DSP_HRTF_OFF
+
+// HRTF set for a symmetric pair of virtual speakers, in flash
+//
+// A symmetric pair needs only the ipsilateral and contralateral responses
+// (L->L = R->R, L->R = R->L). They are stored in shuffler form so the four
+// convolutions reduce to two on the mid/side signals:
+//   sum  = ipsi + contra, applied to (L + R) / 2
+//   diff = ipsi - contra, applied to (L - R) / 2
+// Generated by DSP_Host/hrtf_gen.py into dsp_hrtf_sets.c.
+typedef struct {
+    const char* name;
+    const float* sum;
+    const float* diff;
+} dsp_hrtf_set_t;
+
+extern const dsp_hrtf_set_t dsp_hrtf_sets[DSP_HRTF_SET_COUNT];
+
+// Coefficient bank, written by the main loop and swapped at a block boundary
+typedef struct {
+    int8_t set;         // Index into dsp_hrtf_sets, or DSP_HRTF_OFF
+} dsp_hrtf_coef_t;
+
+// Headphone virtualiser
+//
+// Mid and side are written into doubled circular histories so every output
+// sample is one contiguous dot product per filter, both filters in the same
+// loop. A set change fades the stage out to dry, swaps the filters and fades
+// back in, the histories keep running while it is off.
+typedef struct {
+    dsp_hrtf_coef_t coef[2];
+    dsp_bank_t bank;
+    dsp_override_t auto_set;            // Automation, applied on top of the active bank
+
+    int8_t running;                     // Set the filters currently use
+    dsp_smooth_t mix;                   // Wet amount, linear fade
+    float hist_s[2U * DSP_HRTF_TAPS];   // Mid history, each sample stored twice
+    float hist_d[2U * DSP_HRTF_TAPS];   // Side history
+    uint32_t pos;                       // Newest sample index in the histories
+} dsp_hrtf_t;
+
+// Function Prototypes
+void dsp_hrtf_init(dsp_hrtf_t* h, float fs);
+int8_t dsp_hrtf_find(const char* name);
+bool dsp_hrtf_set(dsp_hrtf_t* h, int8_t set);
+int8_t dsp_hrtf_get(const dsp_hrtf_t* h);
+bool dsp_hrtf_set_param(dsp_hrtf_t* h, uint8_t param, float value);
+void dsp_hrtf_process(dsp_hrtf_t* h, float* left, float* right, uint32_t frames);
+
+#endif // DSP_HRTF_H
@@ -0,0 +1,14 @@
+#ifndef DSP_MEM_H
+#define DSP_MEM_H
+
+// Places CPU-only DSP state (delay lines, filter histories) in the 64 KB
+// core-coupled RAM, which is zero-wait and off the DMA bus matrix. The
+// startup code does not initialise .ccmram, so objects there must be set
+// up by their init function. Host builds have no CCM and ignore it.
+#ifdef DSP_HOST
+#define DSP_CCMRAM
+#else
+#define DSP_CCMRAM  __attribute__((section(".ccmram")))
+#endif
+
+#endif // DSP_MEM_H
@@ -0,0 +1,55 @@
+#ifndef DSP_OVERSAMPLE_H
+#define DSP_OVERSAMPLE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define DSP_OS_MAX_FACTOR    4U
+#define DSP_OS_MAX_FRAMES    64U   // Base-rate frames per call, matches DSP_PIPELINE_MAX_FRAMES
+#define DSP_OS_PAIRS_2X      8U    // Half-band side-tap pairs, 1x <-> 2x (31 taps)
+#define DSP_OS_PAIRS_4X      4U    // Half-band side-tap pairs, 2x <-> 4x (15 taps)
+#define DSP_OS_MAX_PAIRS     DSP_OS_PAIRS_2X
+
+// Process function run at the oversampled rate, same shape as a pipeline stage
+typedef void (*dsp_os_fn_t)(void* state, float* left, float* right, uint32_t frames);
+
+// Polyphase half-band interpolator (one channel)
+//
+// Only the centre tap and the side taps at odd distances are non-zero, so
+// one phase is a plain delay and the other is a symmetric K-pair sum.
+typedef struct {
+    float hist[2U * DSP_OS_MAX_PAIRS - 1U];
+} dsp_hb_up_t;
+
+// Polyphase half-band decimator (one channel), input split into even/odd phases
+typedef struct {
+    float even_hist[2U * DSP_OS_MAX_PAIRS - 1U];
+    float odd_hist[DSP_OS_MAX_PAIRS];
+} dsp_hb_down_t;
+
+// 2x / 4x oversampling wrapper for non-linear stages
+//
+// Upsamples a stereo block through one or two half-band stages, runs the
+// wrapped function at factor * fs and decimates back. The wrapped stage must
+// be initialised for the oversampled rate.
+typedef struct {
+    uint8_t factor;                 // 1, 2 or 4
+    dsp_hb_up_t up[2][2];           // [half-band stage][channel]
+    dsp_hb_down_t down[2][2];
+    float work_l[DSP_OS_MAX_FACTOR * DSP_OS_MAX_FRAMES];
+    float work_r[DSP_OS_MAX_FACTOR * DSP_OS_MAX_FRAMES];
+
+    // Filter input with the history in front, per instance so that instances
+    // in different contexts (audio interrupt, bench) never share it
+    float scratch[2U * DSP_OS_MAX_PAIRS - 1U + 2U * DSP_OS_MAX_FRAMES];
+    float scratch_odd[DSP_OS_MAX_PAIRS + 2U * DSP_OS_MAX_FRAMES];
+} dsp_oversample_t;
+
+// Function Prototypes
+void  dsp_oversample_init(dsp_oversample_t* os, uint8_t factor);
+void  dsp_oversample_reset(dsp_oversample_t* os);
+void  dsp_oversample_process(dsp_oversample_t* os, dsp_os_fn_t fn, void* state,
+                             float* left, float* right, uint32_t frames);
+float dsp_oversample_latency(const dsp_oversample_t* os);
+
+#endif // DSP_OVERSAMPLE_H
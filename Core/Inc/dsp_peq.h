@@ -0,0 +1,52 @@
+#ifndef DSP_PEQ_H
+#define DSP_PEQ_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "dsp_bank.h"
+#include "dsp_biquad.h"
+#include "dsp_smooth.h"
+
+// Parameter ranges
+#define DSP_PEQ_MAX_SECTIONS     10U     // AutoEQ ParametricEQ.txt uses 10 filters
+#define DSP_PEQ_PREAMP_MIN_DB    -40.0f
+#define DSP_PEQ_PREAMP_MAX_DB    12.0f
+#define DSP_PEQ_POLE_MAX         0.9999f // Largest pole radius accepted for a section
+#define DSP_PEQ_COEF_MAX         16.0f   // Largest |b| accepted, catches garbage payloads
+#define DSP_PEQ_SMOOTH_MS        10.0f   // Pre-amp glide
+
+// Automation parameters (dsp_peq_set_param)
+#define DSP_PEQ_PARAM_PREAMP_DB  0U
+
+// Coefficient bank, written by the main loop and swapped at a block boundary
+typedef struct {
+    uint8_t count;                               // Active sections, 0 = pre-amp only
+    float preamp;                                // Linear gain
+    dsp_biquad_coef_t sec[DSP_PEQ_MAX_SECTIONS];
+} dsp_peq_coef_t;
+
+// Parametric EQ cascade loaded as ready-made biquad coefficients
+//
+// The host designs the sections (see peq_import.py), the device only checks
+// that each one is finite and stable before it is published. The same
+// cascade runs on both channels; section state carries over a reload so a
+// new curve does not restart the filters from silence.
+typedef struct {
+    dsp_peq_coef_t coef[2];
+    dsp_bank_t bank;
+    dsp_override_t auto_preamp;    // Automation, applied on top of the active bank
+
+    dsp_smooth_t preamp;
+    uint8_t running;                                        // Sections with valid state
+    dsp_biquad_state_t st[2][DSP_PEQ_MAX_SECTIONS];
+} dsp_peq_t;
+
+// Function Prototypes
+void dsp_peq_init(dsp_peq_t* p, float fs);
+bool dsp_peq_section_valid(const dsp_biquad_coef_t* c);
+bool dsp_peq_load(dsp_peq_t* p, const dsp_biquad_coef_t* sec, uint8_t count, float preamp_db);
+uint8_t dsp_peq_count(const dsp_peq_t* p);
+bool dsp_peq_set_param(dsp_peq_t* p, uint8_t param, float value);
+void dsp_peq_process(dsp_peq_t* p, float* left, float* right, uint32_t frames);
+
+#endif // DSP_PEQ_H
@@ -0,0 +1,78 @@
+#ifndef DSP_PIPELINE_H
+#define DSP_PIPELINE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "dsp_bank.h"
+#include "dsp_oversample.h"
+#include "dsp_auto.h"
+
+#define DSP_PIPELINE_MAX_STAGES  8U
+#define DSP_PIPELINE_MAX_FRAMES  64U   // Largest chunk handed to a stage
+#define DSP_PIPELINE_FADE_FRAMES 48U   // Bypass cross-fade length (1 ms at 48 kHz)
+
+// Status codes
+#define DSP_PIPELINE_OK       0
+#define DSP_PIPELINE_BUSY     1   // Previous change not yet picked up by the audio path
+#define DSP_PIPELINE_INVALID  2
+
+// Stage process function, works in place on planar stereo
+typedef void (*dsp_stage_fn_t)(void* state, float* left, float* right, uint32_t frames);
+
+// Stage parameter setter for automation, runs in the audio path between chunks
+typedef bool (*dsp_param_fn_t)(void* state, uint8_t param, float value);
+
+// Registered stage (one instance of an effect)
+typedef struct {
+    const char* name;
+    dsp_stage_fn_t process;
+    void* state;
+    dsp_bank_t* bank;   // Coefficient bank adopted at block boundaries, may be NULL
+    dsp_oversample_t* os;   // Runs the stage at 2x/4x when set, may be NULL
+    dsp_param_fn_t set_param;   // Automation target, may be NULL
+    float wet;          // Applied wet level, owned by the audio path, carried across chunks
+    bool auto_bypass;   // Bypassed by automation, on top of the chain slot
+    int8_t perf_id;     // Cycle counter for this stage
+} dsp_stage_t;
+
+// One entry of the processing order
+typedef struct {
+    uint8_t stage;      // Index into the stage registry
+    bool bypass;
+} dsp_slot_t;
+
+typedef struct {
+    uint8_t count;
+    dsp_slot_t slots[DSP_PIPELINE_MAX_STAGES];
+} dsp_chain_t;
+
+// Function Prototypes
+
+// Setup
+void    dsp_pipeline_init(void);
+int8_t  dsp_pipeline_register(const char* name, dsp_stage_fn_t process, void* state, dsp_bank_t* bank);
+int8_t  dsp_pipeline_find(const char* name);
+uint8_t dsp_pipeline_stage_count(void);
+const char* dsp_pipeline_stage_name(uint8_t stage);
+uint8_t dsp_pipeline_set_oversample(uint8_t stage, dsp_oversample_t* os);
+uint8_t dsp_pipeline_set_param_fn(uint8_t stage, dsp_param_fn_t fn);
+float   dsp_pipeline_stage_latency(uint8_t stage);
+float   dsp_pipeline_latency(void);
+
+// Reconfiguration (main loop), each call publishes one new chain
+uint8_t dsp_pipeline_insert(uint8_t stage, uint8_t pos);
+uint8_t dsp_pipeline_remove(uint8_t pos);
+uint8_t dsp_pipeline_move(uint8_t from, uint8_t to);
+uint8_t dsp_pipeline_bypass(uint8_t pos, bool bypass);
+void    dsp_pipeline_get_chain(dsp_chain_t* out);
+bool    dsp_pipeline_pending(void);
+void    dsp_pipeline_apply_pending(void);
+
+// Automation (main loop), events are queued with dsp_auto_push()
+uint32_t dsp_pipeline_frame(void);
+bool    dsp_pipeline_auto_bypassed(uint8_t stage);
+
+// Audio path
+void    dsp_pipeline_process(float* left, float* right, uint32_t frames);
+
+#endif // DSP_PIPELINE_H
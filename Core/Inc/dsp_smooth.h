@@ -0,0 +1,59 @@
+#ifndef DSP_SMOOTH_H
+#define DSP_SMOOTH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define DSP_SMOOTH_EPS  1e-5f   // One-pole is treated as settled within this distance
+
+// Smoothed parameter
+//
+// Glides from its current value to a target either exponentially (one-pole,
+// time constant in ms) or linearly over a fixed number of samples. The audio
+// path sets the target once per block and calls dsp_smooth_next() per sample.
+typedef struct {
+    float value;        // Current value
+    float target;
+    float coef;         // One-pole coefficient per sample, 0 selects the linear ramp
+    float step;         // Linear ramp increment per sample
+    uint32_t ramp_len;  // Linear ramp length in samples
+    uint32_t remaining; // Linear ramp samples left
+} dsp_smooth_t;
+
+// Function Prototypes
+void dsp_smooth_init_one_pole(dsp_smooth_t* p, float fs, float time_ms, float value);
+void dsp_smooth_init_linear(dsp_smooth_t* p, float fs, float time_ms, float value);
+void dsp_smooth_set_target(dsp_smooth_t* p, float target);
+void dsp_smooth_snap(dsp_smooth_t* p, float value);
+
+/**
+ * @brief Advance by one sample
+ * @return Smoothed value for this sample
+ */
+static inline float dsp_smooth_next(dsp_smooth_t* p)
+{
+    if (p->coef != 0.0f) {
+        p->value += p->coef * (p->target - p->value);
+    } else if (p->remaining > 0) {
+        p->value = (--p->remaining == 0) ? p->target : p->value + p->step;
+    }
+    return p->value;
+}
+
+/**
+ * @brief true once the value has reached its target (snaps a one-pole that is close enough)
+ */
+static inline bool dsp_smooth_settled(dsp_smooth_t* p)
+{
+    if (p->coef == 0.0f) {
+        return p->remaining == 0;
+    }
+    float d = p->target - p->value;
+    if (d < DSP_SMOOTH_EPS && d > -DSP_SMOOTH_EPS) {
+        p->value = p->target;
+        return true;
+    }
+    return false;
+}
+
+#endif // DSP_SMOOTH_H
@@ -0,0 +1,63 @@
+#ifndef DSP_VBASS_H
+#define DSP_VBASS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "dsp_biquad.h"
+#include "dsp_bank.h"
+#include "dsp_smooth.h"
+
+// Parameter ranges
+#define DSP_VBASS_CUTOFF_MIN_HZ    40.0f
+#define DSP_VBASS_CUTOFF_MAX_HZ    250.0f
+#define DSP_VBASS_HARM_MIN_DB      -24.0f
+#define DSP_VBASS_HARM_MAX_DB      12.0f
+#define DSP_VBASS_HARM_LP_RATIO    4.0f   // Harmonics are band-limited to cutoff..4*cutoff
+#define DSP_VBASS_SMOOTH_MS        10.0f  // Parameter smoothing time constant
+
+// Automation parameters (dsp_vbass_set_param)
+#define DSP_VBASS_PARAM_HARM_DB    0U     // Harmonic level in dB, only while enabled
+
+// Coefficient bank, written by the main loop and swapped at a block boundary
+typedef struct {
+    bool enable;
+    dsp_biquad_coef_t split_lp;
+    dsp_biquad_coef_t harm_hp;
+    dsp_biquad_coef_t harm_lp;
+
+    // Gain targets the smoothed gains glide to
+    float harm_gain;
+    float cut_gain;     // 1 - keep
+    float even_mix;
+} dsp_vbass_coef_t;
+
+// Psychoacoustic virtual bass
+//
+// The mono sum is split at the cutoff with a 4th-order Linkwitz-Riley low-pass.
+// The low band drives a rectifier (even harmonics) and a soft clipper (odd
+// harmonics); the result is band-passed to cutoff..4*cutoff and added back to
+// both channels while (1 - keep) of the original low band is removed.
+typedef struct {
+    float fs;
+    dsp_vbass_coef_t coef[2];
+    dsp_bank_t bank;
+    dsp_override_t auto_harm;      // Automation, applied on top of the active bank
+
+    // Filter state, kept across coefficient swaps
+    dsp_biquad_state_t split_st[2];
+    dsp_biquad_state_t harm_hp_st;
+    dsp_biquad_state_t harm_lp_st;
+
+    // Smoothed gains
+    dsp_smooth_t harm_gain;
+    dsp_smooth_t cut_gain;
+    dsp_smooth_t even_mix;
+} dsp_vbass_t;
+
+// Function Prototypes
+void dsp_vbass_init(dsp_vbass_t* vb, float fs);
+bool dsp_vbass_set(dsp_vbass_t* vb, bool enable, float cutoff_hz, float harm_db, float keep, float even_mix);
+bool dsp_vbass_set_param(dsp_vbass_t* vb, uint8_t param, float value);
+void dsp_vbass_process(dsp_vbass_t* vb, float* left, float* right, uint32_t frames);
+
+#endif // DSP_VBASS_H
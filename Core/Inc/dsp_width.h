@@ -0,0 +1,52 @@
+#ifndef DSP_WIDTH_H
+#define DSP_WIDTH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "dsp_biquad.h"
+#include "dsp_bank.h"
+#include "dsp_smooth.h"
+
+// Parameter ranges
+#define DSP_WIDTH_MAX_PCT        200U   // 0 = mono, 100 = unchanged, 200 = double side level
+#define DSP_WIDTH_HPF_MIN_HZ     20.0f
+#define DSP_WIDTH_HPF_MAX_HZ     500.0f
+#define DSP_WIDTH_SMOOTH_MS      10.0f
+
+// Automation parameters (dsp_width_set_param)
+#define DSP_WIDTH_PARAM_PCT      0U     // Width in percent
+
+// Coefficient bank, written by the main loop and swapped at a block boundary
+typedef struct {
+    bool hpf_enable;
+    dsp_biquad_coef_t hpf;
+    float mid_gain;     // Gain targets
+    float side_gain;
+} dsp_width_coef_t;
+
+// Mid/side stereo width
+//
+// M = (L+R)/2 and S = (L-R)/2 are scaled by gains from a per-percent table and
+// matrixed back in one pass. Above 100 % the mid gain is reduced so that a
+// hard-panned full-scale input never exceeds full scale. The side channel can
+// be high-passed to keep low frequencies centred while widening.
+typedef struct {
+    float fs;
+    dsp_width_coef_t coef[2];
+    dsp_bank_t bank;
+    dsp_override_t auto_mid;   // Automation, applied on top of the active bank
+    dsp_override_t auto_side;
+    dsp_biquad_state_t hpf_st;
+    bool hpf_running;   // Side filter was active in the previous block
+
+    dsp_smooth_t mid_gain;
+    dsp_smooth_t side_gain;
+} dsp_width_t;
+
+// Function Prototypes
+void dsp_width_init(dsp_width_t* w, float fs);
+bool dsp_width_set(dsp_width_t* w, uint16_t width_pct, bool side_hpf, float hpf_hz);
+bool dsp_width_set_param(dsp_width_t* w, uint8_t param, float value);
+void dsp_width_process(dsp_width_t* w, float* left, float* right, uint32_t frames);
+
+#endif // DSP_WIDTH_H
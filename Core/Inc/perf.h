@@ -0,0 +1,57 @@
+#ifndef PERF_H
+#define PERF_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef DSP_HOST
+#include <time.h>
+#define PERF_CLOCK_HZ      1000000000UL      // Host builds count nanoseconds
+#else
+#include "stm32f4xx.h"
+#define PERF_CLOCK_HZ      SystemCoreClock   // DWT counts core cycles
+#endif
+
+#define PERF_MAX_COUNTERS  16U
+
+// Fixed counters, DSP stages register theirs after these
+typedef enum {
+    PERF_ID_I2S_IRQ = 0,   // DMA1_Stream4_IRQHandler (block render)
+    PERF_ID_USB_IRQ,       // OTG_FS_IRQHandler
+    PERF_ID_CHAIN,         // Whole DSP chain per block
+    PERF_ID_SPECTRUM,      // Spectrum FFT in PendSV
+    PERF_ID_FIXED_COUNT
+} perf_fixed_id_t;
+
+// Per-counter statistics, written only by the context that owns the counter
+typedef struct {
+    const char* name;
+    uint32_t calls;
+    uint32_t min;
+    uint32_t max;
+    uint64_t total;
+    volatile bool reset;   // Requested by the shell, applied by the owner on its next record
+} perf_counter_t;
+
+// Function Prototypes
+void   perf_init(uint32_t budget_cycles);
+int8_t perf_register(const char* name);
+void   perf_record(int8_t id, uint32_t cycles);
+void   perf_reset(void);
+void   perf_report(void);
+
+/**
+ * @brief Current DWT cycle count (monotonic nanoseconds on the host), wraps at 32 bits
+ */
+static inline uint32_t perf_cycles(void)
+{
+#ifdef DSP_HOST
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec);
+#else
+    return DWT->CYCCNT;
+#endif
+}
+
+#endif // PERF_H
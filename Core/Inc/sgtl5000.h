@@ -10,6 +10,38 @@
 #define I2C_SUCCESS 0
 #define I2C_FAIL 1
 #define I2C_MISMATCH 2
+#define I2C_PENDING 0xFF // Future not completed yet
+
+// Register shadow cache: every even address up to the last DAP register
+#define SGTL5000_REG_LAST   0x013A
+#define SGTL5000_REG_COUNT  ((SGTL5000_REG_LAST / 2U) + 1U)
+
+// Read back every _verify write over I2C (debug), off by default
+#ifndef SGTL5000_VERIFY_WRITES
+#define SGTL5000_VERIFY_WRITES  false
+#endif
+
+// Asynchronous I2C transaction queue
+#define SGTL5000_I2C_QUEUE_LEN   128U // Entries (writes, reads and delays), power of two
+#define SGTL5000_I2C_TIMEOUT_MS  20U  // A transfer still running after this is failed
+#define SGTL5000_I2C_BUSY_US     20U  // Longest wait for the previous STOP before a transfer starts
+#define SGTL5000_I2C_BURST_MAX   8U   // Registers per burst write (DAP_COEF_WR_B1_MSB..A2_LSB)
+#define SGTL5000_I2C_IRQ_PRIO    5U   // I2C1 EV/ER priority set in HAL_I2C_MspInit, the queue lock masks up to it
+
+// Ramp engine: GEQ bands and bass level step one code per SysTick
+#define SGTL5000_RAMP_QUEUE_SLACK 2U  // Skip a tick while more than this is queued
+#define SGTL5000_RAMP_MAX_STEPS   127U // Longest ramp (bass level 0x00..0x7F), GEQ is at most 0x5F
+
+// Health monitor: CHIP_ID/ANA_STATUS/DIG_POWER check period
+#define SGTL5000_HEALTH_PERIOD_MS 500U
+
+// I2C1 pins, driven as GPIO to free a stuck bus (see stm32f4xx_hal_msp.c)
+#define SGTL5000_I2C_GPIO_PORT    GPIOB
+#define SGTL5000_I2C_SCL_PIN      GPIO_PIN_6
+#define SGTL5000_I2C_SDA_PIN      GPIO_PIN_7
+
+// Init: VAG charge-up (normal ramp, REF_CTRL SMALL_POP = 0) before LINEOUT/HP unmute
+#define SGTL5000_VAG_RAMP_MS      200U
 
 // I2C Address
 #define SGTL5000_ADDR 0x0A << 1 // 7-bit address shifted left for HAL I2C
@@ -186,6 +218,44 @@
 #define CHIP_CLK_TOP_CTRL_INPUT_FREQ_DIV2 0x1 // 0x1 = Divide input frequency by 2
 #define CHIP_CLK_TOP_CTRL_INPUT_FREQ_DIV1 0x0 // 0x0 = Do not divide input frequency
 
+// CHIP_ID (0x0000) / CHIP_ANA_STATUS (0x0036)
+#define SGTL5000_CHIP_ID_PART      0xA0   // PARTID, bits 15:8
+#define CHIP_ANA_STATUS_LRSHORT    0x0200 // Bit 9, headphone L/R short
+#define CHIP_ANA_STATUS_CSHORT     0x0100 // Bit 8, headphone centre short
+#define CHIP_ANA_STATUS_PLL_LOCKED 0x0010 // Bit 4
+
+// DAP_AUDIO_EQ (0x0108) EQ mode
+#define DAP_AUDIO_EQ_EN_MASK       0x0003
+#define DAP_AUDIO_EQ_BYPASS        0x0  // 0x0 = EQ disabled
+#define DAP_AUDIO_EQ_PEQ           0x1  // 0x1 = 7-band parametric EQ
+#define DAP_AUDIO_EQ_TONE          0x2  // 0x2 = Bass/treble tone control
+#define DAP_AUDIO_EQ_GEQ           0x3  // 0x3 = 5-band graphic EQ
+
+// DAP_PEQ (0x0102) / DAP_FLT_COEF_ACCESS (0x010C)
+#define DAP_PEQ_EN_MASK            0x0007 // Number of PEQ filters in use, 0..7
+#define DAP_FLT_COEF_ACCESS_WR     0x0100 // Bit 8, self-clearing: load COEF_WR_* into filter INDEX
+#define DAP_FLT_COEF_ACCESS_INDEX  0x00FF // Bits 7:0
+
+// PEQ coefficients: 20-bit two's complement, 2 integer bits (range -2..+2)
+#define SGTL5000_PEQ_BANDS         7U
+#define SGTL5000_PEQ_FS            48000.0f // Codec sample rate (CHIP_CLK_CTRL)
+#define SGTL5000_PEQ_COEF_FRAC     18       // Fraction bits
+#define SGTL5000_PEQ_COEF_MAX      ((1L << 19) - 1)
+
+// DAP_AVC_CTRL (0x0124) Automatic volume control
+#define DAP_AVC_CTRL_MAX_GAIN_MASK    0x3000 // Bits 13:12, 0x0 = 0 dB, 0x1 = +6 dB, 0x2 = +12 dB
+#define DAP_AVC_CTRL_MAX_GAIN_SHIFT   12
+#define DAP_AVC_CTRL_LBI_RESPONSE_MASK 0x0300 // Bits 9:8, level integrator 0/25/50/100 ms
+#define DAP_AVC_CTRL_HARD_LIMIT_EN    0x0020 // Bit 5, hard limiter instead of a soft compressor
+#define DAP_AVC_CTRL_EN               0x0001 // Bit 0
+
+// AVC ranges and register scales (SGTL5000 datasheet)
+#define SGTL5000_AVC_THRESH_MIN_DB    (-96.0f)
+#define SGTL5000_AVC_THRESH_0DB       (0.636f * 32768.0f) // DAP_AVC_THRESHOLD code at 0 dBFS
+#define SGTL5000_AVC_RATE_MAX         0x0FFFU             // 12-bit ATTACK/DECAY rate
+#define SGTL5000_AVC_ATTACK_DB_LSB    0.8f                // dB/s per code, 0x0028 = 32 dB/s
+#define SGTL5000_AVC_DECAY_DB_LSB     0.05f               // dB/s per code, 0x0050 = 4 dB/s
+
 // Surround Sound Modes
 typedef enum {
   SGTL_SURROUND_OFF    = 0x0, // disabled
@@ -193,23 +263,132 @@ typedef enum {
   SGTL_SURROUND_STEREO = 0x3  // enable, stereo input
 } sgtl_surround_mode_t;
 
+// PEQ band filter types (RBJ cookbook designs)
+typedef enum {
+  SGTL_PEQ_FLAT = 0,  // pass-through
+  SGTL_PEQ_PEAK,
+  SGTL_PEQ_LOWSHELF,
+  SGTL_PEQ_HIGHSHELF,
+  SGTL_PEQ_LOWPASS,
+  SGTL_PEQ_HIGHPASS,
+  SGTL_PEQ_NOTCH
+} sgtl_peq_type_t;
+
+// AVC settings, in the units of the setAVC command
+typedef struct {
+    bool    enable;
+    bool    hard_limit;
+    uint8_t max_gain_db;  // 0, 6 or 12
+    float   threshold_db; // dBFS, -96..0
+    float   attack_dbps;  // Gain reduction rate, dB/s
+    float   decay_dbps;   // Gain recovery rate, dB/s
+} sgtl5000_avc_t;
+
+// Complete codec state for sgtl5000_scene_apply(); PEQ coefficients are not part of it
+typedef struct {
+    uint8_t  eq_mode;        // DAP_AUDIO_EQ_*
+    uint8_t  eq_band[5];     // DAP_EQ_BAND0..4 codes, 0x2F = 0 dB (tone mode: 0 bass, 4 treble)
+    bool     bass_enable;
+    uint8_t  bass_lr_level;  // 0..63
+    uint8_t  bass_level;     // 0..127, 0 = most boost
+    sgtl_surround_mode_t surround_mode;
+    uint8_t  surround_width; // 0..7
+    sgtl5000_avc_t avc;
+    uint16_t dac_vol;        // CHIP_DAC_VOL
+    uint16_t hp_vol;         // CHIP_ANA_HP_CTRL
+    uint16_t line_out_vol;   // CHIP_LINE_OUT_VOL
+    uint16_t routing;        // CHIP_SSS_CTRL
+} sgtl5000_scene_t;
+
+// Codec health monitor counters
+typedef struct {
+    uint32_t checks;
+    uint32_t recoveries;
+    uint32_t bus_resets;
+    uint32_t reinits;
+    uint32_t last_ms;        // Duration of the last recovery
+    const char* last_reason; // "" before the first recovery
+    uint16_t ana_status;     // CHIP_ANA_STATUS at the last check
+    bool     fault;          // Last recovery failed, retried every period
+} sgtl5000_health_t;
+
+// Codec init phases, timed by sgtl5000_init()
+typedef enum {
+    SGTL5000_BOOT_CACHE = 0, // Register shadow fill
+    SGTL5000_BOOT_POWER,     // Analog/digital power up
+    SGTL5000_BOOT_CLOCKS,    // Clocks, I2S, routing
+    SGTL5000_BOOT_DSP,       // DAP, EQ mode, AVC
+    SGTL5000_BOOT_LEVELS,    // Volumes, VAG settle, output unmute
+    SGTL5000_BOOT_PHASES
+} sgtl5000_boot_phase_t;
+
+// Completion future of a queued transaction
+typedef struct {
+    volatile uint8_t status; // I2C_PENDING until the transfer finishes, then I2C_SUCCESS or I2C_FAIL
+    uint16_t value;          // Register value for reads
+} sgtl5000_future_t;
+
 // Function Prototypes
 
 // SGTL5000 Register Operations
 uint8_t  sgtl5000_reg_read(uint16_t reg, uint16_t* val);
+uint8_t  sgtl5000_reg_get(uint16_t reg, uint16_t* val);
 uint8_t  sgtl5000_reg_write(uint16_t reg, uint16_t val);
+uint8_t  sgtl5000_reg_write_burst(uint16_t reg, const uint16_t* vals, uint8_t count);
 uint8_t  sgtl5000_reg_write_verify(uint16_t reg, uint16_t val);
 uint8_t  sgtl5000_reg_modify(uint16_t reg, uint16_t mask, uint8_t shift, uint16_t value);
 uint8_t  sgtl5000_reg_modify_verify(uint16_t reg, uint16_t mask, uint8_t shift, uint16_t value);
 
+// SGTL5000 Asynchronous I2C Queue
+uint8_t  sgtl5000_reg_write_async(uint16_t reg, uint16_t val, sgtl5000_future_t* done);
+uint8_t  sgtl5000_reg_write_burst_async(uint16_t reg, const uint16_t* vals, uint8_t count, sgtl5000_future_t* done);
+uint8_t  sgtl5000_reg_read_async(uint16_t reg, sgtl5000_future_t* done);
+uint8_t  sgtl5000_queue_delay(uint16_t ms);
+uint8_t  sgtl5000_wait(sgtl5000_future_t* done);
+uint8_t  sgtl5000_i2c_flush(void);
+uint16_t sgtl5000_i2c_pending(void);
+uint32_t sgtl5000_i2c_errors(void);
+void     sgtl5000_i2c_poll(void);
+
+// SGTL5000 Ramp Engine
+void     sgtl5000_ramp_tick(void);
+bool     sgtl5000_ramp_active(void);
+uint16_t sgtl5000_ramp_remaining(void);
+uint16_t sgtl5000_ramp_last_steps(void);
+uint32_t sgtl5000_ramp_last_ms(void);
+
+// SGTL5000 Register Shadow Cache
+uint8_t  sgtl5000_cache_fill(void);
+void     sgtl5000_cache_invalidate(void);
+void     sgtl5000_set_verify(bool enable);
+bool     sgtl5000_get_verify(void);
+
 // SGTL5000 Initializaition and Confgiuration
 uint8_t  sgtl5000_read_id();
 uint8_t  sgtl5000_print_all_regs();
 uint8_t  sgtl5000_init();
+const char* sgtl5000_boot_phase_name(uint8_t phase);
+uint32_t sgtl5000_boot_phase_us(uint8_t phase);
+uint32_t sgtl5000_boot_vag_wait_ms(void);
+void     sgtl5000_health_task(void);
+void     sgtl5000_health_get(sgtl5000_health_t* h);
 
 uint8_t sgtl5000_change_dac_volume(uint8_t volume_percent);
 uint8_t sgtl5000_dac_mute(bool mute);
 uint8_t sgtl5000_dap_surround_set(sgtl_surround_mode_t mode, uint8_t width);
 uint8_t sgtl5000_dap_bass_enhance_set(bool enable, uint8_t lr_level, uint8_t bass_level);
+bool    sgtl5000_peq_design(sgtl_peq_type_t type, float fc, float q, float gain_db, int32_t coef[5]);
+uint8_t sgtl5000_dap_peq_set_band(uint8_t band, sgtl_peq_type_t type, float fc, float q, float gain_db);
+uint8_t sgtl5000_dap_peq_enable(void);
+uint8_t sgtl5000_dap_eq_bypass(void);
+uint8_t sgtl5000_dap_eq_mode_set(uint8_t mode);
+uint8_t sgtl5000_dap_eq_mode_get(void);
+uint8_t sgtl5000_dap_avc_set(const sgtl5000_avc_t* avc);
+uint8_t sgtl5000_dap_avc_get(sgtl5000_avc_t* avc);
+uint8_t sgtl5000_scene_get(sgtl5000_scene_t* scene);
+uint8_t sgtl5000_scene_apply(const sgtl5000_scene_t* scene, uint8_t* changed);
+uint8_t sgtl5000_dap_tone_set_db(int8_t bass_db, int8_t treble_db);
+uint8_t sgtl5000_dap_geq_ramp_band(uint16_t band_reg, uint16_t target);
+uint16_t sgtl5000_geq_code_from_db(int8_t db);
 uint8_t sgtl5000_dap_geq_set_bands_db(int8_t b0_db, int8_t b1_db, int8_t b2_db, int8_t b3_db, int8_t b4_db);
 #endif
\ No newline at end of file
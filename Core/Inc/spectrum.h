@@ -0,0 +1,28 @@
+#ifndef SPECTRUM_H
+#define SPECTRUM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Analyser configuration
+#define SPECTRUM_DECIM         2U      // Output stream decimation before the FFT
+#define SPECTRUM_FFT_LEN       512U    // Real FFT length (power of two)
+#define SPECTRUM_BANDS         16U     // Log-spaced output bands
+#define SPECTRUM_BAND_MIN_HZ   60.0f   // Lower edge of band 0
+#define SPECTRUM_BAND_MAX_HZ   12000.0f // Upper edge of the last band
+#define SPECTRUM_RATE_MIN_HZ   1U
+#define SPECTRUM_RATE_MAX_HZ   30U
+#define SPECTRUM_RATE_DEFAULT  20U
+
+// Band levels are reported as 0..63, i.e. -63..0 dBFS in 1 dB steps
+#define SPECTRUM_LEVEL_MAX     63U
+
+// Function Prototypes
+void spectrum_init(uint32_t sample_rate);
+void spectrum_enable(bool enable, uint8_t rate_hz);
+bool spectrum_is_enabled(void);
+bool spectrum_push(const float* left, const float* right, uint32_t frames);
+void spectrum_analyse(void);
+bool spectrum_read(uint8_t bands[SPECTRUM_BANDS]);
+
+#endif // SPECTRUM_H
@@ -0,0 +1,189 @@
+#include "audio_dsp.h"
+#include "dsp_pipeline.h"
+#include "perf.h"
+#include "dsp_mem.h"
+
+// Oversampling factor of the virtual bass harmonic generator (1, 2 or 4).
+// 2x removes the folded-back harmonics but costs about three times the
+// cycles of the plain stage (see the vbass/vbass_os2 rows of 'bench'),
+// which the 31.25 MHz core cannot spare next to the rest of the chain.
+#ifndef AUDIO_DSP_VBASS_OVERSAMPLE
+#define AUDIO_DSP_VBASS_OVERSAMPLE  1U
+#endif
+
+// DSP stage instances
+static dsp_vbass_t vbass;
+static dsp_width_t width;
+static dsp_comp_t comp;
+static dsp_align_t align DSP_CCMRAM;
+static dsp_hrtf_t hrtf DSP_CCMRAM;
+static dsp_peq_t peq;
+static dsp_oversample_t vbass_os;
+
+static void stage_vbass(void* state, float* left, float* right, uint32_t frames)
+{
+    dsp_vbass_process((dsp_vbass_t*)state, left, right, frames);
+}
+
+static void stage_width(void* state, float* left, float* right, uint32_t frames)
+{
+    dsp_width_process((dsp_width_t*)state, left, right, frames);
+}
+
+static void stage_comp(void* state, float* left, float* right, uint32_t frames)
+{
+    dsp_comp_process((dsp_comp_t*)state, left, right, frames);
+}
+
+static void stage_align(void* state, float* left, float* right, uint32_t frames)
+{
+    dsp_align_process((dsp_align_t*)state, left, right, frames);
+}
+
+static void stage_hrtf(void* state, float* left, float* right, uint32_t frames)
+{
+    dsp_hrtf_process((dsp_hrtf_t*)state, left, right, frames);
+}
+
+static void stage_peq(void* state, float* left, float* right, uint32_t frames)
+{
+    dsp_peq_process((dsp_peq_t*)state, left, right, frames);
+}
+
+static bool param_vbass(void* state, uint8_t param, float value)
+{
+    return dsp_vbass_set_param((dsp_vbass_t*)state, param, value);
+}
+
+static bool param_width(void* state, uint8_t param, float value)
+{
+    return dsp_width_set_param((dsp_width_t*)state, param, value);
+}
+
+static bool param_comp(void* state, uint8_t param, float value)
+{
+    return dsp_comp_set_param((dsp_comp_t*)state, param, value);
+}
+
+static bool param_align(void* state, uint8_t param, float value)
+{
+    return dsp_align_set_param((dsp_align_t*)state, param, value);
+}
+
+static bool param_hrtf(void* state, uint8_t param, float value)
+{
+    return dsp_hrtf_set_param((dsp_hrtf_t*)state, param, value);
+}
+
+static bool param_peq(void* state, uint8_t param, float value)
+{
+    return dsp_peq_set_param((dsp_peq_t*)state, param, value);
+}
+
+/**
+ * @brief Create the stage instances and the default chain (call after perf_init)
+ * @param fs Sample rate in Hz
+ */
+void audio_dsp_init(float fs)
+{
+    dsp_oversample_init(&vbass_os, AUDIO_DSP_VBASS_OVERSAMPLE);
+    dsp_vbass_init(&vbass, fs * (float)vbass_os.factor);
+    dsp_width_init(&width, fs);
+    dsp_comp_init(&comp, fs);
+    dsp_align_init(&align, fs);
+    dsp_hrtf_init(&hrtf, fs);
+    dsp_peq_init(&peq, fs);
+
+    // Default chain, every stage is transparent until configured
+    dsp_pipeline_init();
+    int8_t id;
+    id = dsp_pipeline_register("vbass", stage_vbass, &vbass, &vbass.bank);
+    dsp_pipeline_set_param_fn((uint8_t)id, param_vbass);
+    if (vbass_os.factor > 1U) {
+        dsp_pipeline_set_oversample((uint8_t)id, &vbass_os);
+    }
+    dsp_pipeline_insert((uint8_t)id, 0);
+    dsp_pipeline_apply_pending();
+    id = dsp_pipeline_register("width", stage_width, &width, &width.bank);
+    dsp_pipeline_set_param_fn((uint8_t)id, param_width);
+    dsp_pipeline_insert((uint8_t)id, 1);
+    dsp_pipeline_apply_pending();
+    id = dsp_pipeline_register("comp", stage_comp, &comp, &comp.bank);
+    dsp_pipeline_set_param_fn((uint8_t)id, param_comp);
+    dsp_pipeline_insert((uint8_t)id, 2);
+    dsp_pipeline_apply_pending();
+    id = dsp_pipeline_register("align", stage_align, &align, &align.bank);
+    dsp_pipeline_set_param_fn((uint8_t)id, param_align);
+    dsp_pipeline_insert((uint8_t)id, 3);
+    dsp_pipeline_apply_pending();
+    id = dsp_pipeline_register("hrtf", stage_hrtf, &hrtf, &hrtf.bank);
+    dsp_pipeline_set_param_fn((uint8_t)id, param_hrtf);
+    dsp_pipeline_insert((uint8_t)id, 4);
+    dsp_pipeline_apply_pending();
+    // Headphone correction last, it applies to whatever reaches the drivers
+    id = dsp_pipeline_register("peq", stage_peq, &peq, &peq.bank);
+    dsp_pipeline_set_param_fn((uint8_t)id, param_peq);
+    dsp_pipeline_insert((uint8_t)id, 5);
+    dsp_pipeline_apply_pending();
+}
+
+/**
+ * @brief Run the chain on one block in place (audio interrupt context)
+ */
+void audio_dsp_process(float* left, float* right, uint32_t frames)
+{
+    uint32_t start = perf_cycles();
+    dsp_pipeline_process(left, right, frames);
+    perf_record(PERF_ID_CHAIN, perf_cycles() - start);
+}
+
+/**
+ * @brief Convert a processed block to saturated interleaved 16-bit samples
+ * @param left Left channel samples (full scale = 1.0)
+ * @param right Right channel samples
+ * @param out Interleaved output
+ * @param frames Number of frames
+ */
+void audio_dsp_to_s16(const float* left, const float* right, int16_t* out, uint32_t frames)
+{
+    for (uint32_t i = 0; i < frames; i++) {
+        float l = left[i] * 32768.0f;
+        float r = right[i] * 32768.0f;
+        if (l > 32767.0f) l = 32767.0f;
+        if (l < -32768.0f) l = -32768.0f;
+        if (r > 32767.0f) r = 32767.0f;
+        if (r < -32768.0f) r = -32768.0f;
+        out[2 * i]     = (int16_t)l;
+        out[2 * i + 1] = (int16_t)r;
+    }
+}
+
+dsp_vbass_t* audio_dsp_vbass(void)
+{
+    return &vbass;
+}
+
+dsp_width_t* audio_dsp_width(void)
+{
+    return &width;
+}
+
+dsp_comp_t* audio_dsp_comp(void)
+{
+    return &comp;
+}
+
+dsp_align_t* audio_dsp_align(void)
+{
+    return &align;
+}
+
+dsp_hrtf_t* audio_dsp_hrtf(void)
+{
+    return &hrtf;
+}
+
+dsp_peq_t* audio_dsp_peq(void)
+{
+    return &peq;
+}
@@ -0,0 +1,188 @@
+#include "audio_stream.h"
+#include "spectrum.h"
+#include "audio_dsp.h"
+#include "dsp_pipeline.h"
+#include "perf.h"
+#include "stm32f4xx_hal.h"
+#include <string.h>
+
+extern I2S_HandleTypeDef hi2s2;
+
+#define AUDIO_STREAM_FIFO_MASK  (AUDIO_STREAM_FIFO_FRAMES - 1U)
+#define AUDIO_STREAM_DMA_LEN    (2U * AUDIO_STREAM_BLOCK_FRAMES * AUDIO_STREAM_CHANNELS)
+#define AUDIO_STREAM_SYNC_TIMEOUT_MS  5U
+
+// I2S circular DMA buffer, two half-blocks of interleaved L/R samples
+static int16_t i2s_buf[AUDIO_STREAM_DMA_LEN];
+
+// USB -> I2S FIFO, free-running frame indices (single producer / single consumer)
+static int16_t fifo[AUDIO_STREAM_FIFO_FRAMES * AUDIO_STREAM_CHANNELS];
+static volatile uint32_t fifo_wr = 0;
+static volatile uint32_t fifo_rd = 0;
+
+// Planar float working block
+static float blk_l[AUDIO_STREAM_BLOCK_FRAMES];
+static float blk_r[AUDIO_STREAM_BLOCK_FRAMES];
+
+static volatile bool running = false;
+
+/**
+ * @brief Initialize the MCU audio path and its low-priority analysis context
+ */
+void audio_stream_init(void)
+{
+    fifo_wr = 0;
+    fifo_rd = 0;
+    running = false;
+    memset(i2s_buf, 0, sizeof(i2s_buf));
+
+    // Real-time budget: CPU cycles per block
+    perf_init((uint32_t)(((uint64_t)SystemCoreClock * AUDIO_STREAM_BLOCK_FRAMES) / AUDIO_STREAM_FS));
+
+    audio_dsp_init((float)AUDIO_STREAM_FS);
+    spectrum_init(AUDIO_STREAM_FS);
+
+    // PendSV runs block analysis below every audio interrupt
+    HAL_NVIC_SetPriority(PendSV_IRQn, 15, 0);
+}
+
+/**
+ * @brief Start I2S playback from the DMA buffer (called once USB has pre-filled the FIFO)
+ */
+void audio_stream_start(void)
+{
+    if (running) {
+        return;
+    }
+    memset(i2s_buf, 0, sizeof(i2s_buf));
+    if (HAL_I2S_Transmit_DMA(&hi2s2, (uint16_t*)i2s_buf, AUDIO_STREAM_DMA_LEN) == HAL_OK) {
+        running = true;
+    }
+}
+
+/**
+ * @brief Stop I2S playback and flush the FIFO
+ */
+void audio_stream_stop(void)
+{
+    if (!running) {
+        return;
+    }
+    HAL_I2S_DMAStop(&hi2s2);
+    running = false;
+    fifo_rd = fifo_wr;
+}
+
+bool audio_stream_is_running(void)
+{
+    return running;
+}
+
+/**
+ * @brief Wait until the last published DSP chain is in use by the audio path
+ * @return true once adopted, false if the audio path did not pick it up in time
+ */
+bool audio_stream_pipeline_sync(void)
+{
+    uint32_t start = HAL_GetTick();
+    while (dsp_pipeline_pending()) {
+        if (!running) {
+            dsp_pipeline_apply_pending(); // No block boundary will come, adopt it here
+            break;
+        }
+        if ((HAL_GetTick() - start) > AUDIO_STREAM_SYNC_TIMEOUT_MS) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Wait until a stage's published coefficient bank is in use by the audio path
+ * @param bank Coefficient bank of a registered stage
+ * @return true once adopted, false if the audio path did not pick it up in time
+ */
+bool audio_stream_bank_sync(dsp_bank_t* bank)
+{
+    uint32_t start = HAL_GetTick();
+    while (dsp_bank_pending(bank)) {
+        if (!running) {
+            dsp_bank_acquire(bank); // No block boundary will come, adopt it here
+            break;
+        }
+        if ((HAL_GetTick() - start) > AUDIO_STREAM_SYNC_TIMEOUT_MS) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Queue one USB audio packet (16-bit interleaved stereo) for playback
+ * @param pbuf Packet data
+ * @param size Packet size in bytes
+ */
+void audio_stream_usb_rx(const uint8_t* pbuf, uint32_t size)
+{
+    const int16_t* src = (const int16_t*)pbuf;
+    uint32_t frames = size / (AUDIO_STREAM_CHANNELS * sizeof(int16_t));
+    uint32_t wr = fifo_wr;
+
+    for (uint32_t i = 0; i < frames; i++) {
+        if ((wr - fifo_rd) >= AUDIO_STREAM_FIFO_FRAMES) {
+            break; // Overrun, drop the rest of the packet
+        }
+        uint32_t idx = (wr & AUDIO_STREAM_FIFO_MASK) * AUDIO_STREAM_CHANNELS;
+        fifo[idx]     = src[2 * i];
+        fifo[idx + 1] = src[2 * i + 1];
+        wr++;
+    }
+    fifo_wr = wr;
+}
+
+/**
+ * @brief Render one block into the given half of the DMA buffer (audio interrupt context)
+ * @param out Interleaved output half-block
+ */
+static void audio_stream_render(int16_t* out)
+{
+    uint32_t rd = fifo_rd;
+
+    if ((fifo_wr - rd) >= AUDIO_STREAM_BLOCK_FRAMES) {
+        for (uint32_t i = 0; i < AUDIO_STREAM_BLOCK_FRAMES; i++) {
+            uint32_t idx = (rd & AUDIO_STREAM_FIFO_MASK) * AUDIO_STREAM_CHANNELS;
+            blk_l[i] = (float)fifo[idx] * AUDIO_DSP_S16_SCALE;
+            blk_r[i] = (float)fifo[idx + 1] * AUDIO_DSP_S16_SCALE;
+            rd++;
+        }
+        fifo_rd = rd;
+    } else {
+        // Underrun, play silence until USB catches up
+        memset(blk_l, 0, sizeof(blk_l));
+        memset(blk_r, 0, sizeof(blk_r));
+    }
+
+    audio_dsp_process(blk_l, blk_r, AUDIO_STREAM_BLOCK_FRAMES);
+
+    // Analysis tap on the MCU output as sent to the codec, ahead of the codec
+    // DAP (EQ, AVC); the FFT itself runs in PendSV
+    if (spectrum_push(blk_l, blk_r, AUDIO_STREAM_BLOCK_FRAMES)) {
+        SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+    }
+
+    audio_dsp_to_s16(blk_l, blk_r, out, AUDIO_STREAM_BLOCK_FRAMES);
+}
+
+void HAL_I2S_TxHalfCpltCallback(I2S_HandleTypeDef *hi2s)
+{
+    if (hi2s == &hi2s2) {
+        audio_stream_render(&i2s_buf[0]);
+    }
+}
+
+void HAL_I2S_TxCpltCallback(I2S_HandleTypeDef *hi2s)
+{
+    if (hi2s == &hi2s2) {
+        audio_stream_render(&i2s_buf[AUDIO_STREAM_DMA_LEN / 2U]);
+    }
+}
@@ -1,5 +1,11 @@
 #include "cmd_ctrl.h"
 #include "sgtl5000.h"
+#include "spectrum.h"
+#include "audio_stream.h"
+#include "audio_dsp.h"
+#include "dsp_pipeline.h"
+#include "perf.h"
+#include "dsp_bench.h"
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -16,9 +22,136 @@ static volatile uint16_t cmd_len = 0;
 static volatile bool cmd_ready = false;
 static volatile char rx_char;
 
+// Binary payload of 'peqLoad': pre-amp in dB, then b0 b1 b2 a1 a2 per section
+// (float32, little endian) and a CRC-16/CCITT of those bytes (little endian)
+#define PEQ_SECTION_BYTES  (5U * sizeof(float))
+#define PEQ_PAYLOAD_MAX    (sizeof(float) + DSP_PEQ_MAX_SECTIONS * PEQ_SECTION_BYTES + 2U)
+#define PEQ_TIMEOUT_MS     2000U
+#define PEQ_DRAIN_QUIET_MS 100U    // Line silence that ends a discarded payload
+
+static uint8_t bin_buf[PEQ_PAYLOAD_MAX];
+static volatile uint16_t bin_len = 0;
+static volatile uint16_t bin_expected = 0;  // Nonzero while the RX path collects raw bytes
+static volatile bool bin_ready = false;
+static volatile bool bin_discard = false;   // Timed out, the rest of the payload is dropped
+static volatile uint32_t bin_last_rx = 0;   // HAL tick of the last raw byte
+static uint32_t bin_start = 0;
+static uint8_t peq_sections = 0;
+
+// UART TX ring: stdout and the SPEC stream only copy into it, the USART2 TX
+// interrupt drains it at the line rate. Writers mask USART2 while they touch
+// the ring; the I2S DMA interrupt keeps running.
+#define CTRL_TX_RING_SIZE  1024U   // Power of two
+
+static char tx_ring[CTRL_TX_RING_SIZE];
+static volatile uint16_t tx_head = 0;      // Next free byte
+static volatile uint16_t tx_tail = 0;      // Next byte to send, advanced by the TX interrupt
+static volatile uint16_t tx_sending = 0;   // Bytes handed to the HAL, 0 while idle
+static uint32_t spec_dropped = 0;          // SPEC frames dropped behind shell output
+
+static uint16_t ctrl_tx_used(void)
+{
+    return (uint16_t)((tx_head - tx_tail) & (CTRL_TX_RING_SIZE - 1U));
+}
+
+static uint32_t ctrl_tx_lock(void)
+{
+    uint32_t enabled = NVIC_GetEnableIRQ(USART2_IRQn);
+    NVIC_DisableIRQ(USART2_IRQn);
+    __DSB();
+    __ISB();
+    return enabled;
+}
+
+static void ctrl_tx_unlock(uint32_t enabled)
+{
+    if (enabled) {
+        NVIC_EnableIRQ(USART2_IRQn);
+    }
+}
+
+/**
+ * @brief Hand the next contiguous run of the ring to the HAL, under ctrl_tx_lock() or from the TX interrupt
+ */
+static void ctrl_tx_kick(void)
+{
+    if (tx_sending != 0U || tx_head == tx_tail) {
+        return;
+    }
+    uint16_t tail = tx_tail;
+    uint16_t run = (tx_head > tail) ? (uint16_t)(tx_head - tail) : (uint16_t)(CTRL_TX_RING_SIZE - tail);
+    tx_sending = run;
+    if (HAL_UART_Transmit_IT(&huart2, (uint8_t *)&tx_ring[tail], run) != HAL_OK) {
+        tx_sending = 0; // Retried by the next write
+    }
+}
+
+/**
+ * @brief Copy as much as fits into the ring, under ctrl_tx_lock()
+ * @return Bytes copied
+ */
+static uint32_t ctrl_tx_put(const char* p, uint32_t len)
+{
+    uint32_t room = CTRL_TX_RING_SIZE - 1U - ctrl_tx_used();
+    if (len > room) {
+        len = room;
+    }
+    uint16_t head = tx_head;
+    for (uint32_t i = 0; i < len; i++) {
+        tx_ring[head] = p[i];
+        head = (uint16_t)((head + 1U) & (CTRL_TX_RING_SIZE - 1U));
+    }
+    tx_head = head;
+    ctrl_tx_kick();
+    return len;
+}
+
+/**
+ * @brief Queue bytes for the UART (stdout), waiting for room only where the TX interrupt can run
+ */
+void ctrl_tx_write(const char* p, uint32_t len)
+{
+    while (len > 0U) {
+        uint32_t key = ctrl_tx_lock();
+        uint32_t n = ctrl_tx_put(p, len);
+        ctrl_tx_unlock(key);
+        p += n;
+        len -= n;
+        if (n == 0U && (__get_IPSR() != 0U || !key)) {
+            return; // Ring full and nothing drains it from here, drop the rest
+        }
+    }
+}
+
+/**
+ * @brief Queue a whole message or nothing, never waits
+ * @param max_used Only queue while at most this many bytes are pending
+ * @return false if dropped
+ */
+static bool ctrl_tx_try_write(const char* p, uint32_t len, uint32_t max_used)
+{
+    bool queued = false;
+    uint32_t key = ctrl_tx_lock();
+    if (ctrl_tx_used() <= max_used && CTRL_TX_RING_SIZE - 1U - ctrl_tx_used() >= len) {
+        (void)ctrl_tx_put(p, len);
+        queued = true;
+    }
+    ctrl_tx_unlock(key);
+    return queued;
+}
+
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+    if (huart == &huart2) {
+        tx_tail = (uint16_t)((tx_tail + tx_sending) & (CTRL_TX_RING_SIZE - 1U));
+        tx_sending = 0;
+        ctrl_tx_kick();
+    }
+}
+
 // Echo input characters
 static void ctrl_putc(char c) {
-    (void)HAL_UART_Transmit(&huart2, (uint8_t *)&c, 1, 10);
+    (void)ctrl_tx_try_write(&c, 1, CTRL_TX_RING_SIZE);
 }
 
 void ctrl_init()
@@ -33,7 +166,20 @@ void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart)
     if (huart == &huart2) {
         char c = rx_char;
         //ctrl_putc(c); // Echo back
-        if (c == '\b' || c == 0x7F) {// Backspace/DEL
+        if (bin_expected > 0) {
+            // Raw payload bytes, no line editing
+            bin_last_rx = HAL_GetTick();
+            if (!bin_discard) {
+                bin_buf[bin_len] = (uint8_t)c;
+            }
+            bin_len++;
+            if (bin_len >= bin_expected) {
+                bin_expected = 0;
+                bin_ready = !bin_discard;
+                bin_discard = false;
+            }
+        }
+        else if (c == '\b' || c == 0x7F) {// Backspace/DEL
             if (cmd_len > 0) {
                 cmd_len--;
                 // erase on terminal
@@ -115,6 +261,473 @@ static void str_to_lower(char* s)
     }
 }
 
+/**
+ * @brief CRC-16/CCITT (poly 0x1021, init 0xFFFF)
+ */
+static uint16_t ctrl_crc16(const uint8_t* data, uint32_t len)
+{
+    uint16_t crc = 0xFFFFU;
+    for (uint32_t i = 0; i < len; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (uint8_t b = 0; b < 8U; b++) {
+            crc = (crc & 0x8000U) ? (uint16_t)((crc << 1) ^ 0x1021U) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+/**
+ * @brief Read a little-endian float32 from the payload
+ */
+static float ctrl_get_f32(const uint8_t* p)
+{
+    uint32_t u = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    float f;
+    memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+/**
+ * @brief Validate a received 'peqLoad' payload and publish it as one update.
+ */
+static void ctrl_peq_commit(void)
+{
+    uint32_t len = sizeof(float) + peq_sections * PEQ_SECTION_BYTES;
+    uint16_t crc = (uint16_t)(bin_buf[len] | (bin_buf[len + 1U] << 8));
+    if (ctrl_crc16(bin_buf, len) != crc) {
+        printf("ERR invalid: PEQ payload CRC mismatch\r\n");
+        return;
+    }
+
+    float preamp_db = ctrl_get_f32(bin_buf);
+    if (!(preamp_db >= DSP_PEQ_PREAMP_MIN_DB && preamp_db <= DSP_PEQ_PREAMP_MAX_DB)) {
+        printf("ERR invalid: PEQ pre-amp must be -40..12 dB\r\n");
+        return;
+    }
+
+    dsp_biquad_coef_t sec[DSP_PEQ_MAX_SECTIONS];
+    const uint8_t* p = bin_buf + sizeof(float);
+    for (uint8_t i = 0; i < peq_sections; i++) {
+        sec[i].b0 = ctrl_get_f32(p);
+        sec[i].b1 = ctrl_get_f32(p + 4);
+        sec[i].b2 = ctrl_get_f32(p + 8);
+        sec[i].a1 = ctrl_get_f32(p + 12);
+        sec[i].a2 = ctrl_get_f32(p + 16);
+        p += PEQ_SECTION_BYTES;
+        if (!dsp_peq_section_valid(&sec[i])) {
+            printf("ERR invalid: PEQ section %u is unstable\r\n", i + 1U);
+            return;
+        }
+    }
+
+    dsp_peq_t* peq = audio_dsp_peq();
+    if (!audio_stream_bank_sync(&peq->bank) || !dsp_peq_load(peq, sec, peq_sections, preamp_db)) {
+        printf("ERR busy: audio path did not take the previous change\r\n");
+        return;
+    }
+    printf("PEQ OK %u sections\r\n", peq_sections);
+}
+
+/**
+ * @brief 'auto' command: status, clear, or queue one sample-accurate parameter change.
+ *
+ *   auto
+ *   auto clear
+ *   auto <frame|+offset> <stage> <param|bypass> <value>
+ */
+static uint8_t ctrl_auto_cmd(char* args[], int arg_count)
+{
+    if (arg_count == 0) {
+        printf("AUTO frame %lu queued %lu late %lu rejected %lu\r\n",
+               (unsigned long)dsp_pipeline_frame(), (unsigned long)dsp_auto_queued(),
+               (unsigned long)dsp_auto_late(), (unsigned long)dsp_auto_rejected());
+        return CMD_VALID;
+    }
+    str_to_lower(args[0]);
+    if (arg_count == 1 && strcmp(args[0], "clear") == 0) {
+        dsp_auto_clear();
+        return CMD_VALID;
+    }
+    if (arg_count != 4) {
+        printf("ERR invalid: expected 'auto', 'auto clear' or 'auto frame stage param value'\r\n");
+        return CMD_INVALID;
+    }
+
+    dsp_auto_event_t ev;
+    // '+n' schedules relative to the frame now entering the chain
+    if (args[0][0] == '+') {
+        ev.frame = dsp_pipeline_frame() + (uint32_t)strtoul(args[0] + 1, NULL, 10);
+    }
+    else {
+        ev.frame = (uint32_t)strtoul(args[0], NULL, 10);
+    }
+    str_to_lower(args[1]);
+    int8_t stage = dsp_pipeline_find(args[1]);
+    if (stage < 0) {
+        printf("ERR invalid: unknown stage '%s'\r\n", args[1]);
+        return CMD_INVALID;
+    }
+    ev.stage = (uint8_t)stage;
+    str_to_lower(args[2]);
+    if (strcmp(args[2], "bypass") == 0) {
+        ev.param = DSP_AUTO_PARAM_BYPASS;
+    }
+    else {
+        int param = atoi(args[2]);
+        if (param < 0 || param >= (int)DSP_AUTO_PARAM_BYPASS) {
+            printf("ERR invalid: param must be 0..254 or 'bypass'\r\n");
+            return CMD_INVALID;
+        }
+        ev.param = (uint8_t)param;
+    }
+    ev.value = strtof(args[3], NULL);
+
+    if (!dsp_auto_push(&ev)) {
+        printf("ERR busy: automation queue full or event earlier than the last one\r\n");
+        return CMD_INVALID;
+    }
+    printf("AUTO queued @%lu\r\n", (unsigned long)ev.frame);
+    return CMD_VALID;
+}
+
+/**
+ * @brief Report a codec ramp just set up; it runs on SysTick, one step per ms
+ */
+static void ctrl_print_ramp(void)
+{
+    uint16_t steps = sgtl5000_ramp_remaining();
+    printf("Codec ramp %u steps, %u ms\r\n", steps, steps);
+}
+
+// setPEQ filter type names
+static const struct {
+    const char* name;
+    sgtl_peq_type_t type;
+} ctrl_peq_types[] = {
+    {"flat", SGTL_PEQ_FLAT}, {"peak", SGTL_PEQ_PEAK}, {"lowshelf", SGTL_PEQ_LOWSHELF},
+    {"highshelf", SGTL_PEQ_HIGHSHELF}, {"lowpass", SGTL_PEQ_LOWPASS}, {"highpass", SGTL_PEQ_HIGHPASS},
+    {"notch", SGTL_PEQ_NOTCH},
+};
+
+/**
+ * @brief setPEQ on|off | band type fc q gain
+ */
+static uint8_t ctrl_peq_cmd(char* args[], int arg_count)
+{
+    str_to_lower(args[0]);
+    if (arg_count == 1 && strcmp(args[0], "on") == 0) {
+        if (sgtl5000_dap_peq_enable() != I2C_SUCCESS) {
+            return CMD_INVALID;
+        }
+        printf("PEQ on\r\n");
+        return CMD_VALID;
+    }
+    if (arg_count == 1 && strcmp(args[0], "off") == 0) {
+        sgtl5000_dap_eq_bypass();
+        printf("PEQ off\r\n");
+        return CMD_VALID;
+    }
+    if (arg_count != 5) {
+        printf("ERR invalid: setPEQ on|off | band type fc q gain\r\n");
+        return CMD_INVALID;
+    }
+
+    int band = atoi(args[0]);
+    str_to_lower(args[1]);
+    int type = -1;
+    for (uint32_t i = 0; i < sizeof(ctrl_peq_types) / sizeof(ctrl_peq_types[0]); i++) {
+        if (strcmp(args[1], ctrl_peq_types[i].name) == 0) {
+            type = (int)ctrl_peq_types[i].type;
+        }
+    }
+    int fc = atoi(args[2]);
+    float q = strtof(args[3], NULL);
+    float gain = strtof(args[4], NULL);
+
+    if (band < 0 || band >= (int)SGTL5000_PEQ_BANDS) {
+        printf("ERR invalid: band 0..%u\r\n", (unsigned)(SGTL5000_PEQ_BANDS - 1U));
+        return CMD_INVALID;
+    }
+    if (type < 0) {
+        printf("ERR invalid: type flat|peak|lowshelf|highshelf|lowpass|highpass|notch\r\n");
+        return CMD_INVALID;
+    }
+    if (fc < 20 || fc > 20000 || !(q >= 0.1f && q <= 20.0f) || !(gain >= -24.0f && gain <= 12.0f)) {
+        printf("ERR invalid: fc 20..20000 Hz, q 0.1..20, gain -24..12 dB\r\n");
+        return CMD_INVALID;
+    }
+    if (sgtl5000_dap_peq_set_band((uint8_t)band, (sgtl_peq_type_t)type, (float)fc, q, gain) != I2C_SUCCESS) {
+        printf("ERR invalid: PEQ band %d does not fit the codec coefficient range\r\n", band);
+        return CMD_INVALID;
+    }
+    printf("PEQ band %d set\r\n", band);
+    return CMD_VALID;
+}
+
+// setEQProfile presets, GEQ band gains in dB
+static const struct {
+    const char* name;
+    int8_t db[5];
+} ctrl_eq_profiles[] = {
+    {"flat",        {  0,   0,   0,   0,   0}},
+    {"rock",        {  4,   2,   0,   3,   5}},
+    {"pop",         {  3,   1,   0,   2,   4}},
+    {"classical",   { -1,   2,   3,   2,  -1}},
+    {"rap",         {  6,   3,   0,   1,   2}},
+    {"jazz",        {  2,   2,   1,   2,   2}},
+    {"edm",         {  6,   2,   0,   2,   6}},
+    {"vocal",       { -2,   3,   4,   3,  -2}},
+    {"bright",      { -3,  -1,   0,   3,   6}},
+    {"warm",        {  6,   2,   0,  -2,  -3}},
+    {"bassboost",   {  9,   3,   0,   0,   0}},
+    {"trebleboost", {  0,   0,   0,   6,   9}},
+    {"maxsmile",    { 12,   8, -12,   8,  12}},
+    {"midspike",    {-12,  12,  12,  12, -12}},
+};
+
+/**
+ * @brief setEQProfile NAME: switch the codec scene to the preset's GEQ curve
+ *
+ * Goes through the scene diff, so only bands that really differ ramp and a
+ * profile equal to the current curve costs no I2C traffic at all.
+ */
+static uint8_t ctrl_eq_profile_cmd(char* name)
+{
+    str_to_lower(name);
+    for (uint32_t i = 0; i < sizeof(ctrl_eq_profiles) / sizeof(ctrl_eq_profiles[0]); i++) {
+        if (strcmp(name, ctrl_eq_profiles[i].name) != 0) {
+            continue;
+        }
+        sgtl5000_scene_t scene;
+        uint8_t changed = 0;
+        if (sgtl5000_scene_get(&scene) != I2C_SUCCESS) {
+            return CMD_INVALID;
+        }
+        scene.eq_mode = DAP_AUDIO_EQ_GEQ;
+        for (uint8_t b = 0; b < 5; b++) {
+            scene.eq_band[b] = (uint8_t)sgtl5000_geq_code_from_db(ctrl_eq_profiles[i].db[b]);
+        }
+        if (sgtl5000_scene_apply(&scene, &changed) != I2C_SUCCESS) {
+            return CMD_INVALID;
+        }
+        printf("Scene %u registers changed\r\n", changed);
+        ctrl_print_ramp();
+        return CMD_VALID;
+    }
+    printf("ERR invalid: unknown EQ profile\r\n");
+    return CMD_INVALID;
+}
+
+/**
+ * @brief Print the applied codec AVC settings (decoded from the register shadow)
+ */
+static void ctrl_print_avc(void)
+{
+    sgtl5000_avc_t avc;
+    if (sgtl5000_dap_avc_get(&avc) != I2C_SUCCESS) {
+        return;
+    }
+    // Tenths, printf has no float support
+    int thr10 = (int)(avc.threshold_db * 10.0f - 0.5f);
+    uint32_t att10 = (uint32_t)(avc.attack_dbps * 10.0f + 0.5f);
+    uint32_t dec100 = (uint32_t)(avc.decay_dbps * 100.0f + 0.5f);
+    printf("AVC %s, threshold -%d.%d dBFS, max gain %u dB, attack %lu.%lu dB/s, decay %lu.%02lu dB/s, limiter %s\r\n",
+           avc.enable ? "on" : "off", -thr10 / 10, -thr10 % 10, avc.max_gain_db,
+           (unsigned long)(att10 / 10U), (unsigned long)(att10 % 10U),
+           (unsigned long)(dec100 / 100U), (unsigned long)(dec100 % 100U),
+           avc.hard_limit ? "hard" : "soft");
+}
+
+/**
+ * @brief setAVC on|off [thr maxgain attack decay limit]
+ */
+static uint8_t ctrl_avc_cmd(char* args[], int arg_count)
+{
+    sgtl5000_avc_t avc;
+    if (sgtl5000_dap_avc_get(&avc) != I2C_SUCCESS) {
+        return CMD_INVALID;
+    }
+    str_to_lower(args[0]);
+    if (strcmp(args[0], "on") == 0) {
+        avc.enable = true;
+    }
+    else if (strcmp(args[0], "off") == 0) {
+        avc.enable = false;
+    }
+    else {
+        printf("ERR invalid: first argument must be 'on' or 'off'\r\n");
+        return CMD_INVALID;
+    }
+    if (arg_count == 6) {
+        float thr = strtof(args[1], NULL);
+        int max_gain = atoi(args[2]);
+        float attack = strtof(args[3], NULL);
+        float decay = strtof(args[4], NULL);
+        int limit = atoi(args[5]);
+        if (!(thr >= -96.0f && thr <= 0.0f) || (max_gain != 0 && max_gain != 6 && max_gain != 12)) {
+            printf("ERR invalid: thr -96..0 dBFS, maxgain 0|6|12 dB\r\n");
+            return CMD_INVALID;
+        }
+        if (!(attack >= 0.8f && attack <= 3276.0f) || !(decay >= 0.05f && decay <= 204.75f)) {
+            printf("ERR invalid: attack 0.8..3276 dB/s, decay 0.05..204.75 dB/s\r\n");
+            return CMD_INVALID;
+        }
+        if (limit != 0 && limit != 1) {
+            printf("ERR invalid: limit 0|1\r\n");
+            return CMD_INVALID;
+        }
+        avc.threshold_db = thr;
+        avc.max_gain_db = (uint8_t)max_gain;
+        avc.attack_dbps = attack;
+        avc.decay_dbps = decay;
+        avc.hard_limit = limit == 1;
+    }
+    if (sgtl5000_dap_avc_set(&avc) != I2C_SUCCESS) {
+        return CMD_INVALID;
+    }
+    ctrl_print_avc();
+    return CMD_VALID;
+}
+
+/**
+ * @brief Print how long each phase of the codec init took at boot
+ */
+static void ctrl_print_boot(void)
+{
+    uint32_t total = 0;
+    for (uint8_t phase = 0; phase < SGTL5000_BOOT_PHASES; phase++) {
+        uint32_t us = sgtl5000_boot_phase_us(phase);
+        total += us;
+        printf("  %-7s %7lu us\r\n", sgtl5000_boot_phase_name(phase), (unsigned long)us);
+    }
+    printf("Codec init %lu us (VAG settle %lu ms)\r\n", (unsigned long)total,
+           (unsigned long)sgtl5000_boot_vag_wait_ms());
+}
+
+/**
+ * @brief Print the codec health monitor state and recovery counters
+ */
+static void ctrl_print_health(void)
+{
+    sgtl5000_health_t h;
+    sgtl5000_health_get(&h);
+    printf("Codec %s, ANA_STATUS 0x%04X, %lu checks, %lu I2C errors\r\n", h.fault ? "FAULT" : "ok",
+           h.ana_status, (unsigned long)h.checks, (unsigned long)sgtl5000_i2c_errors());
+    printf("Recoveries %lu (bus resets %lu, re-inits %lu)", (unsigned long)h.recoveries,
+           (unsigned long)h.bus_resets, (unsigned long)h.reinits);
+    if (h.recoveries > 0U) {
+        printf(", last: %s, %lu ms", h.last_reason, (unsigned long)h.last_ms);
+    }
+    printf("\r\n");
+}
+
+/**
+ * @brief Print the MCU DSP chain and the registered stages.
+ */
+static void ctrl_dsp_list(void)
+{
+    dsp_chain_t chain;
+    dsp_pipeline_get_chain(&chain);
+
+    // Latency in tenths of a sample (oversampled stages can add half samples)
+    uint32_t total_lat10 = (uint32_t)(dsp_pipeline_latency() * 10.0f + 0.5f);
+
+    printf("DSP chain (%u stages, latency %lu.%lu samples):\r\n", chain.count,
+           (unsigned long)(total_lat10 / 10U), (unsigned long)(total_lat10 % 10U));
+    for (uint8_t i = 0; i < chain.count; i++) {
+        uint32_t lat10 = (uint32_t)(dsp_pipeline_stage_latency(chain.slots[i].stage) * 10.0f + 0.5f);
+        printf("  %u: %-8s %s", i, dsp_pipeline_stage_name(chain.slots[i].stage),
+               chain.slots[i].bypass ? "bypass" : (dsp_pipeline_auto_bypassed(chain.slots[i].stage) ? "bypass(auto)" : "active"));
+        if (lat10 > 0) {
+            printf(" (+%lu.%lu)", (unsigned long)(lat10 / 10U), (unsigned long)(lat10 % 10U));
+        }
+        printf("\r\n");
+    }
+    printf("Available:");
+    for (uint8_t s = 0; s < dsp_pipeline_stage_count(); s++) {
+        printf(" %s", dsp_pipeline_stage_name(s));
+    }
+    printf("\r\n");
+}
+
+/**
+ * @brief Handle the "dsp" pipeline commands.
+ *
+ * Every edit is published as a new chain and adopted between audio blocks.
+ * Removing or moving an active stage first bypasses it so it fades out
+ * instead of dropping out mid-waveform.
+ */
+static uint8_t ctrl_dsp_cmd(char* args[], int arg_count)
+{
+    uint8_t status = DSP_PIPELINE_INVALID;
+
+    if (arg_count == 0) {
+        return CMD_INVALID;
+    }
+    str_to_lower(args[0]);
+    if (!audio_stream_pipeline_sync()) {
+        printf("ERR busy: audio path did not take the previous change\r\n");
+        return CMD_INVALID;
+    }
+
+    if (strcmp(args[0], "list") == 0 && arg_count == 1) {
+        ctrl_dsp_list();
+        return CMD_VALID;
+    }
+    else if (strcmp(args[0], "insert") == 0 && (arg_count == 2 || arg_count == 3)) {
+        str_to_lower(args[1]);
+        int8_t stage = dsp_pipeline_find(args[1]);
+        uint8_t pos = (arg_count == 3) ? (uint8_t)atoi(args[2]) : DSP_PIPELINE_MAX_STAGES;
+        if (stage < 0) {
+            printf("ERR invalid: unknown stage\r\n");
+            return CMD_INVALID;
+        }
+        status = dsp_pipeline_insert((uint8_t)stage, pos);
+    }
+    else if (strcmp(args[0], "remove") == 0 && arg_count == 2) {
+        uint8_t pos = (uint8_t)atoi(args[1]);
+        status = dsp_pipeline_bypass(pos, true);
+        if (status == DSP_PIPELINE_OK && audio_stream_pipeline_sync()) {
+            status = dsp_pipeline_remove(pos);
+        }
+    }
+    else if (strcmp(args[0], "move") == 0 && arg_count == 3) {
+        uint8_t from = (uint8_t)atoi(args[1]);
+        uint8_t to = (uint8_t)atoi(args[2]);
+        dsp_chain_t chain;
+        dsp_pipeline_get_chain(&chain);
+        bool was_bypassed = (from < chain.count) ? chain.slots[from].bypass : true;
+        status = dsp_pipeline_bypass(from, true);
+        if (status == DSP_PIPELINE_OK && audio_stream_pipeline_sync()) {
+            status = dsp_pipeline_move(from, to);
+        }
+        if (status == DSP_PIPELINE_OK && !was_bypassed && audio_stream_pipeline_sync()) {
+            status = dsp_pipeline_bypass(to, false);
+        }
+    }
+    else if (strcmp(args[0], "bypass") == 0 && arg_count == 3) {
+        uint8_t pos = (uint8_t)atoi(args[1]);
+        if (strcmp(args[2], "on") == 0) {
+            status = dsp_pipeline_bypass(pos, true);
+        }
+        else if (strcmp(args[2], "off") == 0) {
+            status = dsp_pipeline_bypass(pos, false);
+        }
+    }
+
+    if (status == DSP_PIPELINE_BUSY) {
+        printf("ERR busy: audio path did not take the previous change\r\n");
+        return CMD_INVALID;
+    }
+    if (status != DSP_PIPELINE_OK) {
+        printf("ERR invalid: bad dsp arguments\r\n");
+        return CMD_INVALID;
+    }
+    audio_stream_pipeline_sync();
+    ctrl_dsp_list();
+    return CMD_VALID;
+}
+
 /**
  * @brief Execute a parsed command.
  * @param cmd_name The name of the command to execute.
@@ -138,7 +751,29 @@ uint8_t ctrl_execute_cmd(char* cmd_name, char* args[], int arg_count)
         printf("  setEQProfile NAME               (ROCK, POP, CLASSICAL, RAP, JAZZ, EDM, VOCAL, BRIGHT, WARM, BASSBOOST, TREBLEBOOST, MAXSMILE, MIDSPIKE, FLAT)\r\n");
         printf("  setBassEnhance on|off [lr bass] (0|1 [0..63 0..127]; ramped amount)\r\n");
         printf("  setSurround on|off [width]      (0|1 [0..7])\r\n");
+        printf("  setTone bass treble             (codec tone control, -12..+12 dB each; ramped)\r\n");
+        printf("  setEQMode [off|peq|tone|geq]    (codec EQ mode, switched through flat without a mute)\r\n");
+        printf("  setPEQ on|off | band type fc q gain (codec 7-band PEQ: 0..6, flat|peak|lowshelf|highshelf|lowpass|highpass|notch, Hz, Q, dB)\r\n");
+        printf("  setAVC on|off [thr maxgain attack decay limit] (codec AVC: -96..0 dBFS, 0|6|12 dB, 0.8..3276 dB/s, 0.05..204.75 dB/s, hard limiter 0|1)\r\n");
+        printf("  avc                             (codec AVC settings as applied)\r\n");
+        printf("  setWidth pct [hpf]              (MCU M/S width 0..200 %%, side high-pass 20..500 Hz, 0 = off)\r\n");
+        printf("  setVirtualBass on|off [fc harm keep even] (MCU: 40..250 Hz, -24..+12 dB, 0..100 %%, 0..100 %%)\r\n");
+        printf("  setCompressor on|off [thr ratio knee att rel makeup] (MCU: -60..0 dB, 1..20, 0..24 dB, ms, ms, 0..24 dB)\r\n");
+        printf("  compGR                          (compressor gain reduction: current and peak since last read)\r\n");
+        printf("  setAlign l|r trim pol delay     (MCU: trim -120..60 x0.1 dB, polarity 0|1, delay 0..1000 us)\r\n");
+        printf("  setHrtf off|30deg|45deg|60deg   (MCU headphone virtualiser, virtual speakers at +-angle)\r\n");
+        printf("  auto [clear | frame|+n stage param|bypass value] (sample-accurate DSP parameter change)\r\n");
+        printf("  peqLoad n                       (MCU EQ cascade, 0..10 sections; binary payload after 'PEQ READY', see peq_import.py)\r\n");
         printf("  setVolume code                  (raw DAC code 0..255 or 0xNN)\r\n");
+        printf("  dsp list                        (MCU DSP chain and available stages)\r\n");
+        printf("  dsp insert NAME [pos] | remove pos | move from to | bypass pos on|off\r\n");
+        printf("  perf [reset]                    (DSP/IRQ cycles per block vs real-time budget)\r\n");
+        printf("  bench [reps]                    (DSP kernel cycles per frame, CSV, reps 1..1000)\r\n");
+        printf("  spectrum on|off [rate]          (stream SPEC lines, rate 1..30 Hz)\r\n");
+        printf("  ramp                            (codec GEQ/bass ramp progress and I2C queue state)\r\n");
+        printf("  boot                            (codec init time per phase, DWT)\r\n");
+        printf("  codecHealth                     (codec health checks, I2C bus resets and hot re-inits)\r\n");
+        printf("  codecVerify [on|off]            (read back every codec register write over I2C, debug)\r\n");
         printf("  dump\r\n\r\n");
         return CMD_VALID;
     }
@@ -154,60 +789,124 @@ uint8_t ctrl_execute_cmd(char* cmd_name, char* args[], int arg_count)
         int b4 = atoi(args[4]);
 
         sgtl5000_dap_geq_set_bands_db((int8_t)b0, (int8_t)b1, (int8_t)b2, (int8_t)b3, (int8_t)b4);
-
+        ctrl_print_ramp();
         return CMD_VALID;
     }
     else if (strcmp(cmd_name, "seteqprofile") == 0 && (arg_count == 1)) {
-        str_to_lower(args[0]);
-        if (strcmp(args[0], "flat") == 0) {
-            sgtl5000_dap_geq_set_bands_db( 0,  0,   0,  0,  0);
-        }
-        else if (strcmp(args[0], "rock") == 0) {
-            sgtl5000_dap_geq_set_bands_db( 4,  2,   0,  3,  5);
-        }
-        else if (strcmp(args[0], "pop") == 0) {
-            sgtl5000_dap_geq_set_bands_db( 3,  1,   0,  2,  4);
+        return ctrl_eq_profile_cmd(args[0]);
+    }
+    else if (strcmp(cmd_name, "setbassenhance") == 0 && (arg_count == 1 || arg_count == 3)) {
+        bool enable = false;
+        if (strcmp(args[0], "on") == 0) {
+            enable = true;
         }
-        else if (strcmp(args[0], "classical") == 0) {
-            sgtl5000_dap_geq_set_bands_db(-1,  2,   3,  2, -1);
+        else if (strcmp(args[0], "off") == 0) {
+            enable = false;
         }
-        else if (strcmp(args[0], "rap") == 0) {
-            sgtl5000_dap_geq_set_bands_db( 6,  3,   0,  1,  2);
+        else {
+            printf("ERR invalid: first argument must be 'on' or 'off'\r\n");
+            return CMD_INVALID;
         }
-        else if (strcmp(args[0], "jazz") == 0) {
-            sgtl5000_dap_geq_set_bands_db( 2,  2,   1,  2,  2);
+        uint8_t lr_level = 0x5; // default
+        uint8_t bass_level = 0x1f; // default
+        if (arg_count == 3) {
+            lr_level = (uint8_t)atoi(args[1]);
+            bass_level = (uint8_t)atoi(args[2]);
         }
-        else if (strcmp(args[0], "edm") == 0) {
-            sgtl5000_dap_geq_set_bands_db( 6,  2,   0,  2,  6);
+        sgtl5000_dap_bass_enhance_set(enable, lr_level, bass_level);
+        ctrl_print_ramp();
+        return CMD_VALID;
+    }
+    else if (strcmp(cmd_name, "setsurround") == 0 && (arg_count == 1 || arg_count == 2)) {
+        bool enable = false;
+        if (strcmp(args[0], "on") == 0) {
+            enable = true;
         }
-        else if (strcmp(args[0], "vocal") == 0) {
-            sgtl5000_dap_geq_set_bands_db(-2,  3,   4,  3, -2);
+        else if (strcmp(args[0], "off") == 0) {
+            enable = false;
         }
-        else if (strcmp(args[0], "bright") == 0) {
-            sgtl5000_dap_geq_set_bands_db(-3, -1,   0,  3,  6);
+        else {
+            printf("ERR invalid: first argument must be 'on' or 'off'\r\n");
+            return CMD_INVALID;
         }
-        else if (strcmp(args[0], "warm") == 0) {
-            sgtl5000_dap_geq_set_bands_db( 6,  2,   0, -2, -3);
+        uint8_t width = 4; // default
+        if (arg_count == 2) {
+            width = (uint8_t)atoi(args[1]);
         }
-        else if (strcmp(args[0], "bassboost") == 0) {
-            sgtl5000_dap_geq_set_bands_db( 9,  3,   0,  0,  0);
+        sgtl5000_dap_surround_set(enable ? SGTL_SURROUND_STEREO : SGTL_SURROUND_OFF, width);
+        return CMD_VALID;
+    }
+    else if (strcmp(cmd_name, "settone") == 0 && arg_count == 2) {
+        int bass = atoi(args[0]);
+        int treble = atoi(args[1]);
+        if (bass < -12 || bass > 12 || treble < -12 || treble > 12) {
+            printf("ERR invalid: bass and treble -12..12 dB\r\n");
+            return CMD_INVALID;
         }
-        else if (strcmp(args[0], "trebleboost") == 0) {
-            sgtl5000_dap_geq_set_bands_db( 0,  0,   0,  6,  9);
+        sgtl5000_dap_tone_set_db((int8_t)bass, (int8_t)treble);
+        ctrl_print_ramp();
+        return CMD_VALID;
+    }
+    else if (strcmp(cmd_name, "seteqmode") == 0 && arg_count <= 1) {
+        static const char* const modes[] = {"off", "peq", "tone", "geq"}; // DAP_AUDIO_EQ_* order
+        if (arg_count == 1) {
+            str_to_lower(args[0]);
+            int mode = -1;
+            for (int i = 0; i < 4; i++) {
+                if (strcmp(args[0], modes[i]) == 0) {
+                    mode = i;
+                }
+            }
+            if (mode < 0) {
+                printf("ERR invalid: setEQMode off|peq|tone|geq\r\n");
+                return CMD_INVALID;
+            }
+            if (mode == DAP_AUDIO_EQ_PEQ) {
+                sgtl5000_dap_peq_enable(); // Loads pass-through bands on first use
+            }
+            else {
+                sgtl5000_dap_eq_mode_set((uint8_t)mode);
+            }
+            ctrl_print_ramp();
         }
-        else if (strcmp(args[0], "maxsmile") == 0) {
-            sgtl5000_dap_geq_set_bands_db(12,  8, -12,  8, 12);
+        printf("EQ mode %s\r\n", modes[sgtl5000_dap_eq_mode_get() & DAP_AUDIO_EQ_EN_MASK]);
+        return CMD_VALID;
+    }
+    else if (strcmp(cmd_name, "setavc") == 0 && (arg_count == 1 || arg_count == 6)) {
+        return ctrl_avc_cmd(args, arg_count);
+    }
+    else if (strcmp(cmd_name, "codechealth") == 0 && arg_count == 0) {
+        ctrl_print_health();
+        return CMD_VALID;
+    }
+    else if (strcmp(cmd_name, "boot") == 0 && arg_count == 0) {
+        ctrl_print_boot();
+        return CMD_VALID;
+    }
+    else if (strcmp(cmd_name, "avc") == 0 && arg_count == 0) {
+        ctrl_print_avc();
+        return CMD_VALID;
+    }
+    else if (strcmp(cmd_name, "setpeq") == 0 && (arg_count == 1 || arg_count == 5)) {
+        return ctrl_peq_cmd(args, arg_count);
+    }
+    else if (strcmp(cmd_name, "setwidth") == 0 && (arg_count == 1 || arg_count == 2)) {
+        int width_pct = atoi(args[0]);
+        int hpf_hz = 0; // default, side high-pass off
+        if (width_pct < 0) {
+            width_pct = 0;
         }
-        else if (strcmp(args[0], "midspike") == 0) {
-            sgtl5000_dap_geq_set_bands_db(-12, 12, 12, 12, -12);
+        if (arg_count == 2) {
+            hpf_hz = atoi(args[1]);
         }
-        else {
-            printf("ERR invalid: unknown EQ profile\r\n");
+        dsp_width_t* w = audio_dsp_width();
+        if (!audio_stream_bank_sync(&w->bank) || !dsp_width_set(w, (uint16_t)width_pct, hpf_hz > 0, (float)hpf_hz)) {
+            printf("ERR busy: audio path did not take the previous change\r\n");
             return CMD_INVALID;
         }
         return CMD_VALID;
     }
-    else if (strcmp(cmd_name, "setbassenhance") == 0 && (arg_count == 1 || arg_count == 3)) {
+    else if (strcmp(cmd_name, "setvirtualbass") == 0 && (arg_count == 1 || arg_count == 5)) {
         bool enable = false;
         if (strcmp(args[0], "on") == 0) {
             enable = true;
@@ -219,16 +918,26 @@ uint8_t ctrl_execute_cmd(char* cmd_name, char* args[], int arg_count)
             printf("ERR invalid: first argument must be 'on' or 'off'\r\n");
             return CMD_INVALID;
         }
-        uint8_t lr_level = 0x5; // default
-        uint8_t bass_level = 0x1f; // default
-        if (arg_count == 3) {
-            lr_level = (uint8_t)atoi(args[1]);
-            bass_level = (uint8_t)atoi(args[2]);
+        int cutoff_hz = 100; // default
+        int harm_db = 0;     // default
+        int keep_pct = 100;  // default
+        int even_pct = 50;   // default
+        if (arg_count == 5) {
+            cutoff_hz = atoi(args[1]);
+            harm_db = atoi(args[2]);
+            keep_pct = atoi(args[3]);
+            even_pct = atoi(args[4]);
+        }
+        dsp_vbass_t* vb = audio_dsp_vbass();
+        if (!audio_stream_bank_sync(&vb->bank)
+                || !dsp_vbass_set(vb, enable, (float)cutoff_hz, (float)harm_db,
+                                  (float)keep_pct / 100.0f, (float)even_pct / 100.0f)) {
+            printf("ERR busy: audio path did not take the previous change\r\n");
+            return CMD_INVALID;
         }
-        sgtl5000_dap_bass_enhance_set(enable, lr_level, bass_level);
         return CMD_VALID;
     }
-    else if (strcmp(cmd_name, "setsurround") == 0 && (arg_count == 1 || arg_count == 2)) {
+    else if (strcmp(cmd_name, "setcompressor") == 0 && (arg_count == 1 || arg_count == 7)) {
         bool enable = false;
         if (strcmp(args[0], "on") == 0) {
             enable = true;
@@ -240,11 +949,100 @@ uint8_t ctrl_execute_cmd(char* cmd_name, char* args[], int arg_count)
             printf("ERR invalid: first argument must be 'on' or 'off'\r\n");
             return CMD_INVALID;
         }
-        uint8_t width = 4; // default
-        if (arg_count == 2) {
-            width = (uint8_t)atoi(args[1]);
+        int thresh_db = -20;   // default
+        int ratio = 4;         // default
+        int knee_db = 6;       // default
+        int attack_ms = 5;     // default
+        int release_ms = 100;  // default
+        int makeup_db = 0;     // default
+        if (arg_count == 7) {
+            thresh_db = atoi(args[1]);
+            ratio = atoi(args[2]);
+            knee_db = atoi(args[3]);
+            attack_ms = atoi(args[4]);
+            release_ms = atoi(args[5]);
+            makeup_db = atoi(args[6]);
+        }
+        dsp_comp_t* comp = audio_dsp_comp();
+        if (!audio_stream_bank_sync(&comp->bank)
+                || !dsp_comp_set(comp, enable, (float)thresh_db, (float)ratio, (float)knee_db,
+                                 (float)attack_ms, (float)release_ms, (float)makeup_db)) {
+            printf("ERR busy: audio path did not take the previous change\r\n");
+            return CMD_INVALID;
         }
-        sgtl5000_dap_surround_set(enable ? SGTL_SURROUND_STEREO : SGTL_SURROUND_OFF, width);
+        return CMD_VALID;
+    }
+    else if (strcmp(cmd_name, "compgr") == 0 && arg_count == 0) {
+        float gr_db, peak_db;
+        dsp_comp_read_gr(audio_dsp_comp(), &gr_db, &peak_db);
+        // Tenths of a dB, reported as positive reduction
+        uint32_t gr10 = (uint32_t)(-gr_db * 10.0f + 0.5f);
+        uint32_t peak10 = (uint32_t)(-peak_db * 10.0f + 0.5f);
+        printf("GR %lu.%lu dB (peak %lu.%lu dB)\r\n",
+               (unsigned long)(gr10 / 10U), (unsigned long)(gr10 % 10U),
+               (unsigned long)(peak10 / 10U), (unsigned long)(peak10 % 10U));
+        return CMD_VALID;
+    }
+    else if (strcmp(cmd_name, "setalign") == 0 && arg_count == 4) {
+        str_to_lower(args[0]);
+        uint8_t channel;
+        if (strcmp(args[0], "l") == 0) {
+            channel = 0;
+        }
+        else if (strcmp(args[0], "r") == 0) {
+            channel = 1;
+        }
+        else {
+            printf("ERR invalid: channel must be 'l' or 'r'\r\n");
+            return CMD_INVALID;
+        }
+        int trim_db10 = atoi(args[1]);
+        int invert = atoi(args[2]);
+        int delay_us = atoi(args[3]);
+        if (trim_db10 < DSP_ALIGN_TRIM_MIN_DB10 || trim_db10 > DSP_ALIGN_TRIM_MAX_DB10
+                || (invert != 0 && invert != 1) || delay_us < 0 || delay_us > (int)DSP_ALIGN_MAX_DELAY_US) {
+            printf("ERR invalid: expected trim -120..60, polarity 0|1, delay 0..1000 us\r\n");
+            return CMD_INVALID;
+        }
+        dsp_align_t* al = audio_dsp_align();
+        if (!audio_stream_bank_sync(&al->bank)
+                || !dsp_align_set(al, channel, (int16_t)trim_db10, invert == 1, (uint16_t)delay_us)) {
+            printf("ERR busy: audio path did not take the previous change\r\n");
+            return CMD_INVALID;
+        }
+        return CMD_VALID;
+    }
+    else if (strcmp(cmd_name, "sethrtf") == 0 && arg_count == 1) {
+        str_to_lower(args[0]);
+        int8_t set = DSP_HRTF_OFF;
+        if (strcmp(args[0], "off") != 0) {
+            set = dsp_hrtf_find(args[0]);
+            if (set == DSP_HRTF_OFF) {
+                printf("ERR invalid: unknown HRTF set '%s'\r\n", args[0]);
+                return CMD_INVALID;
+            }
+        }
+        dsp_hrtf_t* hr = audio_dsp_hrtf();
+        if (!audio_stream_bank_sync(&hr->bank) || !dsp_hrtf_set(hr, set)) {
+            printf("ERR busy: audio path did not take the previous change\r\n");
+            return CMD_INVALID;
+        }
+        return CMD_VALID;
+    }
+    else if (strcmp(cmd_name, "peqload") == 0 && arg_count == 1) {
+        int count = atoi(args[0]);
+        if (count < 0 || count > (int)DSP_PEQ_MAX_SECTIONS) {
+            printf("ERR invalid: sections must be 0..%u\r\n", (unsigned)DSP_PEQ_MAX_SECTIONS);
+            return CMD_INVALID;
+        }
+        // The RX path switches to raw bytes until the payload is complete
+        peq_sections = (uint8_t)count;
+        bin_len = 0;
+        bin_ready = false;
+        bin_discard = false;
+        bin_start = HAL_GetTick();
+        bin_expected = (uint16_t)(sizeof(float) + (uint32_t)count * PEQ_SECTION_BYTES + 2U);
+        printf("PEQ READY %u\r\n", bin_expected);
         return CMD_VALID;
     }
     else if (strcmp(cmd_name , "setvolume") == 0 && (arg_count == 1)) {
@@ -252,21 +1050,147 @@ uint8_t ctrl_execute_cmd(char* cmd_name, char* args[], int arg_count)
         sgtl5000_change_dac_volume(vol_percent);
         return CMD_VALID;
     }
+    else if (strcmp(cmd_name, "dsp") == 0 && arg_count >= 1) {
+        return ctrl_dsp_cmd(args, arg_count);
+    }
+    else if (strcmp(cmd_name, "auto") == 0) {
+        return ctrl_auto_cmd(args, arg_count);
+    }
+    else if (strcmp(cmd_name, "perf") == 0 && (arg_count == 0 || arg_count == 1)) {
+        if (arg_count == 1) {
+            str_to_lower(args[0]);
+            if (strcmp(args[0], "reset") != 0) {
+                printf("ERR invalid: expected 'perf' or 'perf reset'\r\n");
+                return CMD_INVALID;
+            }
+            perf_reset();
+            printf("perf counters reset\r\n");
+            return CMD_VALID;
+        }
+        perf_report();
+        return CMD_VALID;
+    }
+    else if (strcmp(cmd_name, "bench") == 0 && (arg_count == 0 || arg_count == 1)) {
+        int reps = DSP_BENCH_DEFAULT_REPS; // default
+        if (arg_count == 1) {
+            reps = atoi(args[0]);
+        }
+        if (reps < 1 || reps > (int)DSP_BENCH_MAX_REPS) {
+            printf("ERR invalid: reps must be 1..%u\r\n", (unsigned)DSP_BENCH_MAX_REPS);
+            return CMD_INVALID;
+        }
+        dsp_bench_run((uint32_t)reps);
+        return CMD_VALID;
+    }
+    else if (strcmp(cmd_name, "spectrum") == 0 && (arg_count == 1 || arg_count == 2)) {
+        bool enable = false;
+        if (strcmp(args[0], "on") == 0) {
+            enable = true;
+        }
+        else if (strcmp(args[0], "off") == 0) {
+            enable = false;
+        }
+        else {
+            printf("ERR invalid: first argument must be 'on' or 'off'\r\n");
+            return CMD_INVALID;
+        }
+        uint8_t rate = SPECTRUM_RATE_DEFAULT;
+        if (arg_count == 2) {
+            rate = (uint8_t)atoi(args[1]);
+        }
+        spectrum_enable(enable, rate);
+        if (!enable) {
+            printf("Spectrum off, %lu frames dropped\r\n", (unsigned long)spec_dropped);
+        }
+        spec_dropped = 0;
+        return CMD_VALID;
+    }
     else if (strcmp(cmd_name, "dumpregs") == 0 && arg_count == 0) {
         sgtl5000_print_all_regs();
         return CMD_VALID;
     }
+    else if (strcmp(cmd_name, "codecverify") == 0 && arg_count <= 1) {
+        if (arg_count == 1) {
+            if (strcmp(args[0], "on") == 0 || strcmp(args[0], "1") == 0) {
+                sgtl5000_set_verify(true);
+            }
+            else if (strcmp(args[0], "off") == 0 || strcmp(args[0], "0") == 0) {
+                sgtl5000_set_verify(false);
+            }
+            else {
+                printf("ERR invalid: codecVerify on|off\r\n");
+                return CMD_INVALID;
+            }
+        }
+        printf("Codec write verify %s\r\n", sgtl5000_get_verify() ? "on" : "off");
+        return CMD_VALID;
+    }
+    else if (strcmp(cmd_name, "ramp") == 0 && arg_count == 0) {
+        if (sgtl5000_ramp_active()) {
+            printf("Codec ramp running, %u steps left\r\n", sgtl5000_ramp_remaining());
+        }
+        else {
+            printf("Codec ramp idle, last %u steps in %lu ms\r\n", sgtl5000_ramp_last_steps(), (unsigned long)sgtl5000_ramp_last_ms());
+        }
+        printf("Codec I2C %u queued, %lu errors\r\n", sgtl5000_i2c_pending(), (unsigned long)sgtl5000_i2c_errors());
+        return CMD_VALID;
+    }
     else {
         printf("Command not recognized!\r\n");
         return CMD_INVALID;
     }
 }
 
+/**
+ * @brief Publish the latest spectrum frame as one "SPEC" line.
+ *
+ * Each band is a single character '0' + level (0..63 -> -63..0 dBFS) to
+ * keep a frame at 23 bytes, 72% of the 9600 baud link at 30 Hz. The line
+ * goes to the TX ring without waiting; a frame is dropped while more than
+ * one line is still pending, so shell replies keep their share of the link
+ * and the display never lags behind.
+ */
+static void ctrl_publish_spectrum(void)
+{
+    uint8_t bands[SPECTRUM_BANDS];
+    char line[5U + SPECTRUM_BANDS + 2U];
+
+    if (!spectrum_is_enabled() || !spectrum_read(bands)) {
+        return;
+    }
+    memcpy(line, "SPEC ", 5);
+    for (uint32_t i = 0; i < SPECTRUM_BANDS; i++) {
+        line[5U + i] = (char)('0' + bands[i]);
+    }
+    line[5U + SPECTRUM_BANDS] = '\r';
+    line[6U + SPECTRUM_BANDS] = '\n';
+    if (!ctrl_tx_try_write(line, sizeof(line), sizeof(line))) {
+        spec_dropped++;
+    }
+}
+
 /**
  * @brief Poll the USART for incoming commands and process them.
  */
 void ctrl_poll(void)
 {
+    ctrl_publish_spectrum();
+
+    if (bin_ready) {
+        bin_ready = false;
+        ctrl_peq_commit();
+    }
+    else if (bin_expected > 0 && !bin_discard && (HAL_GetTick() - bin_start) > PEQ_TIMEOUT_MS) {
+        // Late payload bytes must not reach the line parser: drop them until
+        // the expected count has passed or the line goes quiet
+        printf("ERR timeout: PEQ payload incomplete (%u of %u bytes)\r\n", bin_len, bin_expected);
+        bin_discard = true;
+    }
+    else if (bin_discard && (HAL_GetTick() - bin_last_rx) > PEQ_DRAIN_QUIET_MS) {
+        bin_expected = 0;
+        bin_discard = false;
+    }
+
     if (cmd_ready) {
         char raw[RX_BUFFER_SIZE];
         char line[RX_BUFFER_SIZE];
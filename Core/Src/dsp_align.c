@@ -0,0 +1,210 @@
+#include "dsp_align.h"
+#include <math.h>
+#include <string.h>
+
+#define DSP_ALIGN_MASK  (DSP_ALIGN_LINE_LEN - 1U)
+
+// Interpolator taps for one channel: integer delay of the first tap and weights
+typedef struct {
+    uint32_t base;
+    float c[4];
+} dsp_align_taps_t;
+
+/**
+ * @brief 4-point Lagrange taps for a fractional delay
+ *
+ * Taps sit at delays base..base+3 with base = floor(d) - 1 (at least 0), so
+ * the interpolation point stays between the two middle taps except below one
+ * sample, where it moves towards the first tap and reaches it exactly at 0.
+ */
+static inline void dsp_align_taps(float d, dsp_align_taps_t* t)
+{
+    int32_t di = (int32_t)d;
+    if (di < 1) {
+        di = 1;
+    }
+    float x = d - (float)di + 1.0f;     // Position relative to the first tap, 0..3
+    float xm1 = x - 1.0f;
+    float xm2 = x - 2.0f;
+    float xm3 = x - 3.0f;
+
+    t->base = (uint32_t)(di - 1);
+    t->c[0] = -xm1 * xm2 * xm3 * (1.0f / 6.0f);
+    t->c[1] = x * xm2 * xm3 * 0.5f;
+    t->c[2] = -x * xm1 * xm3 * 0.5f;
+    t->c[3] = x * xm1 * xm2 * (1.0f / 6.0f);
+}
+
+/**
+ * @brief Read the interpolated sample, pos is the index of the newest sample
+ */
+static inline float dsp_align_read(const float* line, uint32_t pos, const dsp_align_taps_t* t)
+{
+    uint32_t p = pos - t->base;
+    return t->c[0] * line[p & DSP_ALIGN_MASK]
+         + t->c[1] * line[(p - 1U) & DSP_ALIGN_MASK]
+         + t->c[2] * line[(p - 2U) & DSP_ALIGN_MASK]
+         + t->c[3] * line[(p - 3U) & DSP_ALIGN_MASK];
+}
+
+/**
+ * @brief Initialize an alignment stage (0 dB, normal polarity, no delay)
+ * @param a Stage instance, may live in CCM RAM (not zeroed at startup)
+ * @param fs Sample rate in Hz
+ */
+void dsp_align_init(dsp_align_t* a, float fs)
+{
+    memset(a, 0, sizeof(*a));
+    a->fs = fs;
+    for (uint32_t ch = 0; ch < 2U; ch++) {
+        a->coef[0].gain[ch] = 1.0f;
+        dsp_smooth_init_one_pole(&a->gain[ch], fs, DSP_ALIGN_SMOOTH_MS, 1.0f);
+        dsp_smooth_init_one_pole(&a->delay[ch], fs, DSP_ALIGN_SMOOTH_MS, 0.0f);
+    }
+    a->coef[1] = a->coef[0];
+    dsp_bank_init(&a->bank);
+}
+
+/**
+ * @brief Set the trim, polarity and delay of one channel (main loop)
+ * @param a Stage instance
+ * @param channel 0 = left, 1 = right
+ * @param trim_db10 Gain trim in 0.1 dB (DSP_ALIGN_TRIM_MIN_DB10..DSP_ALIGN_TRIM_MAX_DB10)
+ * @param invert true to invert the polarity
+ * @param delay_us Delay in microseconds (0..DSP_ALIGN_MAX_DELAY_US)
+ * @return false if the previous update has not been picked up by the audio path yet
+ */
+bool dsp_align_set(dsp_align_t* a, uint8_t channel, int16_t trim_db10, bool invert, uint16_t delay_us)
+{
+    if (channel > 1U || dsp_bank_pending(&a->bank)) {
+        return false;
+    }
+    if (trim_db10 < DSP_ALIGN_TRIM_MIN_DB10) trim_db10 = DSP_ALIGN_TRIM_MIN_DB10;
+    if (trim_db10 > DSP_ALIGN_TRIM_MAX_DB10) trim_db10 = DSP_ALIGN_TRIM_MAX_DB10;
+    if (delay_us > DSP_ALIGN_MAX_DELAY_US) delay_us = DSP_ALIGN_MAX_DELAY_US;
+
+    float delay = (float)delay_us * a->fs / 1000000.0f;
+    const float max_delay = (float)(DSP_ALIGN_LINE_LEN - 4U);
+    if (delay > max_delay) {
+        delay = max_delay;
+    }
+
+    // The other channel keeps its settings: start from the active bank
+    uint8_t staging = dsp_bank_staging(&a->bank);
+    a->coef[staging] = a->coef[a->bank.active];
+
+    dsp_align_coef_t* k = &a->coef[staging];
+    float gain = powf(10.0f, (float)trim_db10 / 200.0f);
+    k->gain[channel] = invert ? -gain : gain;
+    k->delay[channel] = delay;
+
+    dsp_bank_publish(&a->bank);
+    return true;
+}
+
+/**
+ * @brief Override one parameter at a chunk boundary (audio path, automation)
+ * @return false for an unknown parameter
+ */
+bool dsp_align_set_param(dsp_align_t* a, uint8_t param, float value)
+{
+    const dsp_align_coef_t* k = &a->coef[a->bank.active];
+    uint32_t ch = param & 1U;
+
+    if (param == DSP_ALIGN_PARAM_TRIM_L || param == DSP_ALIGN_PARAM_TRIM_R) {
+        const float lo = (float)DSP_ALIGN_TRIM_MIN_DB10 / 10.0f;
+        const float hi = (float)DSP_ALIGN_TRIM_MAX_DB10 / 10.0f;
+        if (value < lo) value = lo;
+        if (value > hi) value = hi;
+        float gain = powf(10.0f, value / 20.0f);
+        dsp_override_set(&a->auto_gain[ch], k->gain[ch], (k->gain[ch] < 0.0f) ? -gain : gain);
+        return true;
+    }
+    if (param == DSP_ALIGN_PARAM_DELAY_L || param == DSP_ALIGN_PARAM_DELAY_R) {
+        if (value < 0.0f) value = 0.0f;
+        if (value > (float)DSP_ALIGN_MAX_DELAY_US) value = (float)DSP_ALIGN_MAX_DELAY_US;
+        float delay = value * a->fs / 1000000.0f;
+        const float max_delay = (float)(DSP_ALIGN_LINE_LEN - 4U);
+        dsp_override_set(&a->auto_delay[ch], k->delay[ch], (delay > max_delay) ? max_delay : delay);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Process one block in place, both channels in one pass
+ * @param a Stage instance
+ * @param left Left channel samples
+ * @param right Right channel samples
+ * @param frames Number of frames
+ */
+void dsp_align_process(dsp_align_t* a, float* left, float* right, uint32_t frames)
+{
+    const dsp_align_coef_t* bk = &a->coef[a->bank.active];
+    uint32_t pos = a->pos;
+
+    // Local copy with the automation overrides applied
+    dsp_align_coef_t kc;
+    for (uint32_t ch = 0; ch < 2U; ch++) {
+        kc.gain[ch] = dsp_override_apply(&a->auto_gain[ch], bk->gain[ch]);
+        kc.delay[ch] = dsp_override_apply(&a->auto_delay[ch], bk->delay[ch]);
+    }
+    const dsp_align_coef_t* k = &kc;
+
+    for (uint32_t ch = 0; ch < 2U; ch++) {
+        dsp_smooth_set_target(&a->gain[ch], k->gain[ch]);
+        dsp_smooth_set_target(&a->delay[ch], k->delay[ch]);
+    }
+    bool gain_settled = dsp_smooth_settled(&a->gain[0]) && dsp_smooth_settled(&a->gain[1]);
+    bool delay_settled = dsp_smooth_settled(&a->delay[0]) && dsp_smooth_settled(&a->delay[1]);
+
+    // Transparent: keep the lines filled so a later delay change starts from real audio
+    if (gain_settled && delay_settled && k->gain[0] == 1.0f && k->gain[1] == 1.0f
+            && k->delay[0] == 0.0f && k->delay[1] == 0.0f) {
+        for (uint32_t i = 0; i < frames; i++) {
+            pos++;
+            a->line[0][pos & DSP_ALIGN_MASK] = left[i];
+            a->line[1][pos & DSP_ALIGN_MASK] = right[i];
+        }
+        a->pos = pos;
+        return;
+    }
+
+    dsp_align_taps_t tl;
+    dsp_align_taps_t tr;
+    dsp_smooth_t gl = a->gain[0];
+    dsp_smooth_t gr = a->gain[1];
+    float* line_l = a->line[0];
+    float* line_r = a->line[1];
+
+    if (delay_settled) {
+        dsp_align_taps(a->delay[0].value, &tl);
+        dsp_align_taps(a->delay[1].value, &tr);
+        for (uint32_t i = 0; i < frames; i++) {
+            pos++;
+            line_l[pos & DSP_ALIGN_MASK] = left[i];
+            line_r[pos & DSP_ALIGN_MASK] = right[i];
+            left[i] = dsp_smooth_next(&gl) * dsp_align_read(line_l, pos, &tl);
+            right[i] = dsp_smooth_next(&gr) * dsp_align_read(line_r, pos, &tr);
+        }
+    } else {
+        // Delay is gliding: taps follow it per sample
+        dsp_smooth_t dl = a->delay[0];
+        dsp_smooth_t dr = a->delay[1];
+        for (uint32_t i = 0; i < frames; i++) {
+            pos++;
+            line_l[pos & DSP_ALIGN_MASK] = left[i];
+            line_r[pos & DSP_ALIGN_MASK] = right[i];
+            dsp_align_taps(dsp_smooth_next(&dl), &tl);
+            dsp_align_taps(dsp_smooth_next(&dr), &tr);
+            left[i] = dsp_smooth_next(&gl) * dsp_align_read(line_l, pos, &tl);
+            right[i] = dsp_smooth_next(&gr) * dsp_align_read(line_r, pos, &tr);
+        }
+        a->delay[0] = dl;
+        a->delay[1] = dr;
+    }
+
+    a->gain[0] = gl;
+    a->gain[1] = gr;
+    a->pos = pos;
+}
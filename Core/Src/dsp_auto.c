@@ -0,0 +1,116 @@
+#include "dsp_auto.h"
+
+#define DSP_AUTO_MASK  (DSP_AUTO_QUEUE_LEN - 1U)
+
+// Single-producer (main loop) / single-consumer (audio path) queue in
+// push order. Pushes must not go back in time, so the head of the queue is
+// always the next event due and the audio path never has to search.
+static dsp_auto_event_t queue[DSP_AUTO_QUEUE_LEN];
+static volatile uint32_t head = 0;      // Written by the main loop
+static volatile uint32_t tail = 0;      // Written by the audio path
+static volatile bool flush = false;     // Main loop asks the audio path to drop events before flush_to
+static volatile uint32_t flush_to = 0;
+static bool ordered = false;            // last_frame is valid, cleared by dsp_auto_clear()
+static uint32_t last_frame = 0;         // Frame of the newest queued event
+static volatile uint32_t late = 0;      // Events applied after their frame
+static volatile uint32_t rejected = 0;  // Events the stage did not accept
+
+/**
+ * @brief Empty the queue and reset the counters (only while the audio path is stopped)
+ */
+void dsp_auto_init(void)
+{
+    head = 0;
+    tail = 0;
+    flush = false;
+    flush_to = 0;
+    ordered = false;
+    last_frame = 0;
+    late = 0;
+    rejected = 0;
+}
+
+/**
+ * @brief Queue an event (main loop)
+ * @param ev Event, its frame may not be earlier than the one queued before it
+ * @return false if the queue is full or the event is out of order
+ */
+bool dsp_auto_push(const dsp_auto_event_t* ev)
+{
+    uint32_t h = head;
+    if (h - tail >= DSP_AUTO_QUEUE_LEN) {
+        return false;
+    }
+    if (ordered && h != tail && (int32_t)(ev->frame - last_frame) < 0) {
+        return false;
+    }
+    queue[h & DSP_AUTO_MASK] = *ev;
+    last_frame = ev->frame;
+    ordered = true;
+    head = h + 1U;  // Publish after the event is complete
+    return true;
+}
+
+/**
+ * @brief Drop all queued events, takes effect at the next chunk boundary
+ *
+ * Events pushed after the call are kept, and may start from any frame.
+ */
+void dsp_auto_clear(void)
+{
+    flush_to = head;
+    flush = true;
+    ordered = false;
+}
+
+uint32_t dsp_auto_queued(void)
+{
+    return head - tail;
+}
+
+uint32_t dsp_auto_late(void)
+{
+    return late;
+}
+
+uint32_t dsp_auto_rejected(void)
+{
+    return rejected;
+}
+
+/**
+ * @brief Apply the events due at a chunk start and shorten the chunk to the next one (audio path)
+ * @param now Frame index of the first frame of the chunk
+ * @param frames Frames the caller wants to process
+ * @param apply Applies one event
+ * @return Frames to process before the next event is due (1..frames)
+ */
+uint32_t dsp_auto_run(uint32_t now, uint32_t frames, dsp_auto_apply_fn_t apply)
+{
+    if (flush) {
+        flush = false;
+        if ((int32_t)(flush_to - tail) > 0) {
+            tail = flush_to;
+        }
+    }
+    uint32_t t = tail;
+    while (t != head) {
+        const dsp_auto_event_t* ev = &queue[t & DSP_AUTO_MASK];
+        int32_t ahead = (int32_t)(ev->frame - now);
+        if (ahead > 0) {
+            if ((uint32_t)ahead < frames) {
+                frames = (uint32_t)ahead;
+            }
+            break;
+        }
+        if (ahead < 0) {
+            late++;
+        }
+        if (!apply(ev)) {
+            rejected++;
+        }
+        t++;
+    }
+    tail = t;
+    return frames;
+}
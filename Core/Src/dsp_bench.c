@@ -0,0 +1,301 @@
+#include "dsp_bench.h"
+#include "audio_dsp.h"
+#include "audio_stream.h"
+#include "dsp_align.h"
+#include "dsp_biquad.h"
+#include "dsp_comp.h"
+#include "dsp_hrtf.h"
+#include "dsp_oversample.h"
+#include "dsp_peq.h"
+#include "dsp_vbass.h"
+#include "dsp_width.h"
+#include "perf.h"
+#include <stdio.h>
+#include <string.h>
+
+// DSP kernel benchmark, shared by the 'bench' shell command and DSP_Host/dspbench
+//
+// Every kernel runs on private instances over the same pseudo-random stereo
+// vector at each block size. The table reports PERF_CLOCK_HZ ticks per frame
+// (DWT cycles on target, ns on the host) as the minimum and the average over
+// the repetitions; the minimum filters out interrupts that hit a run.
+
+#define DSP_BENCH_BIQUAD_SECTIONS  4U
+
+static const uint32_t block_sizes[] = { 16U, AUDIO_STREAM_BLOCK_FRAMES, 128U, DSP_BENCH_MAX_FRAMES };
+
+// Test vector and working copy
+static float vec_l[DSP_BENCH_MAX_FRAMES];
+static float vec_r[DSP_BENCH_MAX_FRAMES];
+static float buf_l[DSP_BENCH_MAX_FRAMES];
+static float buf_r[DSP_BENCH_MAX_FRAMES];
+static int16_t buf_s16[DSP_BENCH_MAX_FRAMES * 2U];
+
+// Private kernel instances
+static dsp_biquad_coef_t bq_coef[DSP_BENCH_BIQUAD_SECTIONS];
+static dsp_biquad_state_t bq_state[2][DSP_BENCH_BIQUAD_SECTIONS];
+static dsp_vbass_t vbass;
+static dsp_width_t width;
+static dsp_oversample_t os;
+static dsp_comp_t comp;
+static dsp_align_t align;
+static dsp_hrtf_t hrtf;
+static dsp_peq_t peq;
+
+typedef struct {
+    const char* name;
+    void (*setup)(void);
+    void (*run)(uint32_t frames);
+} dsp_bench_kernel_t;
+
+static void bench_biquad_setup(void)
+{
+    const float f0[DSP_BENCH_BIQUAD_SECTIONS] = { 80.0f, 400.0f, 2500.0f, 9000.0f };
+    for (uint32_t i = 0; i < DSP_BENCH_BIQUAD_SECTIONS; i++) {
+        dsp_biquad_design_lpf(&bq_coef[i], (float)AUDIO_STREAM_FS, f0[i], DSP_BIQUAD_Q_BUTTERWORTH);
+        dsp_biquad_reset(&bq_state[0][i]);
+        dsp_biquad_reset(&bq_state[1][i]);
+    }
+}
+
+static void bench_biquad_run(uint32_t frames)
+{
+    for (uint32_t i = 0; i < DSP_BENCH_BIQUAD_SECTIONS; i++) {
+        dsp_biquad_process(&bq_coef[i], &bq_state[0][i], buf_l, frames);
+        dsp_biquad_process(&bq_coef[i], &bq_state[1][i], buf_r, frames);
+    }
+}
+
+static void bench_vbass_setup(void)
+{
+    dsp_vbass_init(&vbass, (float)AUDIO_STREAM_FS);
+    dsp_vbass_set(&vbass, true, 80.0f, 6.0f, 0.5f, 0.5f);
+    dsp_bank_acquire(&vbass.bank);
+}
+
+static void bench_vbass_run(uint32_t frames)
+{
+    dsp_vbass_process(&vbass, buf_l, buf_r, frames);
+}
+
+static void bench_vbass_stage(void* state, float* left, float* right, uint32_t frames)
+{
+    dsp_vbass_process((dsp_vbass_t*)state, left, right, frames);
+}
+
+static void bench_width_setup(void)
+{
+    dsp_width_init(&width, (float)AUDIO_STREAM_FS);
+    dsp_width_set(&width, 150U, false, 0.0f);
+    dsp_bank_acquire(&width.bank);
+}
+
+static void bench_width_hpf_setup(void)
+{
+    dsp_width_init(&width, (float)AUDIO_STREAM_FS);
+    dsp_width_set(&width, 150U, true, 120.0f);
+    dsp_bank_acquire(&width.bank);
+}
+
+static void bench_width_run(uint32_t frames)
+{
+    dsp_width_process(&width, buf_l, buf_r, frames);
+}
+
+static void bench_vbass_os2_setup(void)
+{
+    dsp_oversample_init(&os, 2U);
+    dsp_vbass_init(&vbass, 2.0f * (float)AUDIO_STREAM_FS);
+    dsp_vbass_set(&vbass, true, 80.0f, 6.0f, 0.5f, 0.5f);
+    dsp_bank_acquire(&vbass.bank);
+}
+
+static void bench_vbass_os_run(uint32_t frames)
+{
+    dsp_oversample_process(&os, bench_vbass_stage, &vbass, buf_l, buf_r, frames);
+}
+
+static void bench_os_setup(uint8_t factor)
+{
+    dsp_oversample_init(&os, factor);
+}
+
+static void bench_os2_setup(void)
+{
+    bench_os_setup(2U);
+}
+
+static void bench_os4_setup(void)
+{
+    bench_os_setup(4U);
+}
+
+static void bench_identity(void* state, float* left, float* right, uint32_t frames)
+{
+    (void)state;
+    (void)left;
+    (void)right;
+    (void)frames;
+}
+
+static void bench_os_run(uint32_t frames)
+{
+    dsp_oversample_process(&os, bench_identity, NULL, buf_l, buf_r, frames);
+}
+
+static void bench_comp_setup(void)
+{
+    dsp_comp_init(&comp, (float)AUDIO_STREAM_FS);
+    dsp_comp_set(&comp, true, -20.0f, 4.0f, 6.0f, 5.0f, 100.0f, 3.0f);
+    dsp_bank_acquire(&comp.bank);
+}
+
+static void bench_comp_run(uint32_t frames)
+{
+    dsp_comp_process(&comp, buf_l, buf_r, frames);
+}
+
+static void bench_align_setup(void)
+{
+    dsp_align_init(&align, (float)AUDIO_STREAM_FS);
+    dsp_align_set(&align, 1U, -15, true, 250U);
+    dsp_bank_acquire(&align.bank);
+    // Let the delay settle so the run measures the steady-state path
+    for (uint32_t i = 0; i < 20U; i++) {
+        dsp_align_process(&align, buf_l, buf_r, DSP_BENCH_MAX_FRAMES);
+    }
+}
+
+static void bench_align_run(uint32_t frames)
+{
+    dsp_align_process(&align, buf_l, buf_r, frames);
+}
+
+static void bench_hrtf_setup(void)
+{
+    dsp_hrtf_init(&hrtf, (float)AUDIO_STREAM_FS);
+    dsp_hrtf_set(&hrtf, 0);
+    dsp_bank_acquire(&hrtf.bank);
+    // Let the fade-in finish so the run measures the steady-state path
+    for (uint32_t i = 0; i < 2U; i++) {
+        dsp_hrtf_process(&hrtf, buf_l, buf_r, DSP_BENCH_MAX_FRAMES);
+    }
+}
+
+static void bench_hrtf_run(uint32_t frames)
+{
+    dsp_hrtf_process(&hrtf, buf_l, buf_r, frames);
+}
+
+static void bench_peq_setup(void)
+{
+    dsp_biquad_coef_t sec[DSP_PEQ_MAX_SECTIONS];
+    for (uint32_t i = 0; i < DSP_PEQ_MAX_SECTIONS; i++) {
+        dsp_biquad_design_lpf(&sec[i], (float)AUDIO_STREAM_FS, 1000.0f + 1000.0f * (float)i, DSP_BIQUAD_Q_BUTTERWORTH);
+    }
+    dsp_peq_init(&peq, (float)AUDIO_STREAM_FS);
+    dsp_peq_load(&peq, sec, DSP_PEQ_MAX_SECTIONS, -6.0f);
+    dsp_bank_acquire(&peq.bank);
+}
+
+static void bench_peq_run(uint32_t frames)
+{
+    dsp_peq_process(&peq, buf_l, buf_r, frames);
+}
+
+static void bench_none_setup(void)
+{
+}
+
+static void bench_to_s16_run(uint32_t frames)
+{
+    audio_dsp_to_s16(buf_l, buf_r, buf_s16, frames);
+}
+
+// Add new hot-path kernels here
+static const dsp_bench_kernel_t kernels[] = {
+    { "biquad4",    bench_biquad_setup,    bench_biquad_run },
+    { "vbass",      bench_vbass_setup,     bench_vbass_run },
+    { "vbass_os2",  bench_vbass_os2_setup, bench_vbass_os_run },
+    { "width",      bench_width_setup,     bench_width_run },
+    { "width_hpf",  bench_width_hpf_setup, bench_width_run },
+    { "comp",       bench_comp_setup,      bench_comp_run },
+    { "align",      bench_align_setup,     bench_align_run },
+    { "hrtf",       bench_hrtf_setup,      bench_hrtf_run },
+    { "peq10",      bench_peq_setup,       bench_peq_run },
+    { "os2",        bench_os2_setup,       bench_os_run },
+    { "os4",        bench_os4_setup,       bench_os_run },
+    { "f32_to_s16", bench_none_setup,      bench_to_s16_run },
+};
+
+/**
+ * @brief Fill the test vector with deterministic noise at about -6 dBFS
+ */
+static void dsp_bench_fill(void)
+{
+    uint32_t seed = 0x12345678U;
+    for (uint32_t i = 0; i < DSP_BENCH_MAX_FRAMES; i++) {
+        seed = seed * 1664525U + 1013904223U;
+        vec_l[i] = (float)(int32_t)seed * (0.5f / 2147483648.0f);
+        seed = seed * 1664525U + 1013904223U;
+        vec_r[i] = (float)(int32_t)seed * (0.5f / 2147483648.0f);
+    }
+}
+
+/**
+ * @brief Print ticks per frame with two decimals
+ */
+static void dsp_bench_print_rate(uint64_t ticks, uint32_t frames)
+{
+    uint64_t x100 = (ticks * 100U) / frames;
+    printf("%lu.%02lu", (unsigned long)(x100 / 100U), (unsigned long)(x100 % 100U));
+}
+
+/**
+ * @brief Run every kernel at every block size and print a CSV table
+ * @param reps Timed calls per kernel and block size (1..DSP_BENCH_MAX_REPS)
+ */
+void dsp_bench_run(uint32_t reps)
+{
+    if (reps == 0) {
+        reps = 1;
+    }
+    if (reps > DSP_BENCH_MAX_REPS) {
+        reps = DSP_BENCH_MAX_REPS;
+    }
+    dsp_bench_fill();
+
+#ifdef DSP_HOST
+    printf("# bench unit=ns clock=%lu reps=%lu\r\n", (unsigned long)PERF_CLOCK_HZ, (unsigned long)reps);
+#else
+    printf("# bench unit=cycles clock=%lu reps=%lu\r\n", (unsigned long)PERF_CLOCK_HZ, (unsigned long)reps);
+#endif
+    printf("kernel,block,min_per_frame,avg_per_frame\r\n");
+
+    for (uint32_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++) {
+        for (uint32_t b = 0; b < sizeof(block_sizes) / sizeof(block_sizes[0]); b++) {
+            uint32_t frames = block_sizes[b];
+            uint32_t min = UINT32_MAX;
+            uint64_t total = 0;
+
+            kernels[k].setup();
+            for (uint32_t r = 0; r < reps; r++) {
+                memcpy(buf_l, vec_l, frames * sizeof(float));
+                memcpy(buf_r, vec_r, frames * sizeof(float));
+                uint32_t start = perf_cycles();
+                kernels[k].run(frames);
+                uint32_t t = perf_cycles() - start;
+                total += t;
+                if (t < min) {
+                    min = t;
+                }
+            }
+
+            printf("%s,%lu,", kernels[k].name, (unsigned long)frames);
+            dsp_bench_print_rate(min, frames);
+            printf(",");
+            dsp_bench_print_rate(total / reps, frames);
+            printf("\r\n");
+        }
+    }
+}
@@ -0,0 +1,75 @@
+#include "dsp_biquad.h"
+#include <math.h>
+
+#define DSP_PI 3.14159265358979f
+
+/**
+ * @brief Design a 2nd-order low-pass section (RBJ cookbook)
+ * @param c Output coefficients
+ * @param fs Sample rate in Hz
+ * @param f0 Cutoff frequency in Hz
+ * @param q Quality factor
+ */
+void dsp_biquad_design_lpf(dsp_biquad_coef_t* c, float fs, float f0, float q)
+{
+    float w0 = 2.0f * DSP_PI * f0 / fs;
+    float cw = cosf(w0);
+    float alpha = sinf(w0) / (2.0f * q);
+    float a0_inv = 1.0f / (1.0f + alpha);
+
+    c->b0 = 0.5f * (1.0f - cw) * a0_inv;
+    c->b1 = (1.0f - cw) * a0_inv;
+    c->b2 = c->b0;
+    c->a1 = -2.0f * cw * a0_inv;
+    c->a2 = (1.0f - alpha) * a0_inv;
+}
+
+/**
+ * @brief Design a 2nd-order high-pass section (RBJ cookbook)
+ * @param c Output coefficients
+ * @param fs Sample rate in Hz
+ * @param f0 Cutoff frequency in Hz
+ * @param q Quality factor
+ */
+void dsp_biquad_design_hpf(dsp_biquad_coef_t* c, float fs, float f0, float q)
+{
+    float w0 = 2.0f * DSP_PI * f0 / fs;
+    float cw = cosf(w0);
+    float alpha = sinf(w0) / (2.0f * q);
+    float a0_inv = 1.0f / (1.0f + alpha);
+
+    c->b0 = 0.5f * (1.0f + cw) * a0_inv;
+    c->b1 = -(1.0f + cw) * a0_inv;
+    c->b2 = c->b0;
+    c->a1 = -2.0f * cw * a0_inv;
+    c->a2 = (1.0f - alpha) * a0_inv;
+}
+
+void dsp_biquad_reset(dsp_biquad_state_t* s)
+{
+    s->z1 = 0.0f;
+    s->z2 = 0.0f;
+}
+
+/**
+ * @brief Filter a buffer in place
+ * @param c Section coefficients
+ * @param s Section state
+ * @param buf Samples to filter
+ * @param n Number of samples
+ */
+void dsp_biquad_process(const dsp_biquad_coef_t* c, dsp_biquad_state_t* s, float* buf, uint32_t n)
+{
+    float b0 = c->b0, b1 = c->b1, b2 = c->b2, a1 = c->a1, a2 = c->a2;
+    float z1 = s->z1, z2 = s->z2;
+
+    for (uint32_t i = 0; i < n; i++) {
+        float x = buf[i];
+        float y = b0 * x + z1;
+        z1 = b1 * x - a1 * y + z2;
+        z2 = b2 * x - a2 * y;
+        buf[i] = y;
+    }
+    s->z1 = z1;
+    s->z2 = z2;
+}
@@ -0,0 +1,187 @@
+#include "dsp_comp.h"
+#include "dsp_fastmath.h"
+#include <math.h>
+#include <string.h>
+
+#define DSP_COMP_FLOOR       1e-9f    // Detector floor (-180 dB), keeps log2 finite
+#define DSP_COMP_SETTLE_DB   0.001f   // Envelope considered released above this
+
+/**
+ * @brief One-pole coefficient for a time constant
+ */
+static float dsp_comp_time_coef(float fs, float ms)
+{
+    return expf(-1000.0f / (ms * fs));
+}
+
+/**
+ * @brief Initialize a compressor (disabled, -20 dB, 4:1, 6 dB knee, 5/100 ms)
+ * @param c Stage instance
+ * @param fs Sample rate in Hz
+ */
+void dsp_comp_init(dsp_comp_t* c, float fs)
+{
+    memset(c, 0, sizeof(*c));
+    c->fs = fs;
+    dsp_smooth_init_one_pole(&c->makeup_db, fs, DSP_COMP_SMOOTH_MS, 0.0f);
+    dsp_bank_init(&c->bank);
+    dsp_comp_set(c, false, -20.0f, 4.0f, 6.0f, 5.0f, 100.0f, 0.0f);
+    dsp_bank_acquire(&c->bank);
+    c->coef[c->bank.active ^ 1U] = c->coef[c->bank.active];
+}
+
+/**
+ * @brief Update the compressor parameters (main loop)
+ * @param c Stage instance
+ * @param enable true to compress, false to release and pass through
+ * @param thresh_db Threshold in dBFS (DSP_COMP_THRESH_MIN_DB..DSP_COMP_THRESH_MAX_DB)
+ * @param ratio Compression ratio (DSP_COMP_RATIO_MIN..DSP_COMP_RATIO_MAX)
+ * @param knee_db Soft knee width in dB (0..DSP_COMP_KNEE_MAX_DB)
+ * @param attack_ms Attack time constant in ms
+ * @param release_ms Release time constant in ms
+ * @param makeup_db Make-up gain in dB (0..DSP_COMP_MAKEUP_MAX_DB)
+ * @return false if the previous update has not been picked up by the audio path yet
+ */
+bool dsp_comp_set(dsp_comp_t* c, bool enable, float thresh_db, float ratio, float knee_db,
+                  float attack_ms, float release_ms, float makeup_db)
+{
+    if (dsp_bank_pending(&c->bank)) {
+        return false;
+    }
+    if (thresh_db < DSP_COMP_THRESH_MIN_DB) thresh_db = DSP_COMP_THRESH_MIN_DB;
+    if (thresh_db > DSP_COMP_THRESH_MAX_DB) thresh_db = DSP_COMP_THRESH_MAX_DB;
+    if (ratio < DSP_COMP_RATIO_MIN) ratio = DSP_COMP_RATIO_MIN;
+    if (ratio > DSP_COMP_RATIO_MAX) ratio = DSP_COMP_RATIO_MAX;
+    if (knee_db < 0.0f) knee_db = 0.0f;
+    if (knee_db > DSP_COMP_KNEE_MAX_DB) knee_db = DSP_COMP_KNEE_MAX_DB;
+    if (attack_ms < DSP_COMP_ATTACK_MIN_MS) attack_ms = DSP_COMP_ATTACK_MIN_MS;
+    if (attack_ms > DSP_COMP_ATTACK_MAX_MS) attack_ms = DSP_COMP_ATTACK_MAX_MS;
+    if (release_ms < DSP_COMP_RELEASE_MIN_MS) release_ms = DSP_COMP_RELEASE_MIN_MS;
+    if (release_ms > DSP_COMP_RELEASE_MAX_MS) release_ms = DSP_COMP_RELEASE_MAX_MS;
+    if (makeup_db < 0.0f) makeup_db = 0.0f;
+    if (makeup_db > DSP_COMP_MAKEUP_MAX_DB) makeup_db = DSP_COMP_MAKEUP_MAX_DB;
+
+    dsp_comp_coef_t* k = &c->coef[dsp_bank_staging(&c->bank)];
+    k->enable = enable;
+    k->thresh_db = thresh_db;
+    k->knee_db = knee_db;
+    k->slope = 1.0f / ratio - 1.0f;
+    k->attack_a = dsp_comp_time_coef(c->fs, attack_ms);
+    k->release_a = dsp_comp_time_coef(c->fs, release_ms);
+    k->makeup_db = enable ? makeup_db : 0.0f;
+
+    dsp_bank_publish(&c->bank);
+    return true;
+}
+
+/**
+ * @brief Override one parameter at a chunk boundary (audio path, automation)
+ * @return false for an unknown parameter
+ */
+bool dsp_comp_set_param(dsp_comp_t* c, uint8_t param, float value)
+{
+    const dsp_comp_coef_t* k = &c->coef[c->bank.active];
+    if (param == DSP_COMP_PARAM_THRESH_DB) {
+        if (value < DSP_COMP_THRESH_MIN_DB) value = DSP_COMP_THRESH_MIN_DB;
+        if (value > DSP_COMP_THRESH_MAX_DB) value = DSP_COMP_THRESH_MAX_DB;
+        dsp_override_set(&c->auto_thresh, k->thresh_db, value);
+        return true;
+    }
+    if (param == DSP_COMP_PARAM_MAKEUP_DB) {
+        if (value < 0.0f) value = 0.0f;
+        if (value > DSP_COMP_MAKEUP_MAX_DB) value = DSP_COMP_MAKEUP_MAX_DB;
+        if (k->enable) {
+            dsp_override_set(&c->auto_makeup, k->makeup_db, value);
+        }
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Static soft-knee gain computer
+ * @return Gain reduction in dB (<= 0) for a detector level in dB
+ */
+static inline float dsp_comp_gain_db(const dsp_comp_coef_t* k, float level_db)
+{
+    float over = level_db - k->thresh_db;
+    float half_knee = 0.5f * k->knee_db;
+
+    if (over <= -half_knee) {
+        return 0.0f;
+    }
+    if (over < half_knee) {
+        float x = over + half_knee;
+        return k->slope * x * x / (2.0f * k->knee_db);
+    }
+    return k->slope * over;
+}
+
+/**
+ * @brief Process one block in place
+ * @param c Stage instance
+ * @param left Left channel samples
+ * @param right Right channel samples
+ * @param frames Number of frames
+ */
+void dsp_comp_process(dsp_comp_t* c, float* left, float* right, uint32_t frames)
+{
+    // Local copy with the automation overrides applied
+    dsp_comp_coef_t kc = c->coef[c->bank.active];
+    kc.thresh_db = dsp_override_apply(&c->auto_thresh, kc.thresh_db);
+    kc.makeup_db = dsp_override_apply(&c->auto_makeup, kc.makeup_db);
+    const dsp_comp_coef_t* k = &kc;
+    float env = c->env_db;
+    float peak = c->gr_peak_reset ? 0.0f : c->gr_peak_db;
+    c->gr_peak_reset = false;
+
+    dsp_smooth_set_target(&c->makeup_db, k->makeup_db);
+
+    // Disabled and fully released: pass through untouched
+    if (!k->enable && env > -DSP_COMP_SETTLE_DB && dsp_smooth_settled(&c->makeup_db)) {
+        c->env_db = 0.0f;
+        c->gr_db = 0.0f;
+        c->gr_peak_db = peak;
+        return;
+    }
+
+    dsp_smooth_t makeup = c->makeup_db;
+    const float att = k->attack_a;
+    const float rel = k->release_a;
+
+    for (uint32_t i = 0; i < frames; i++) {
+        float target = 0.0f;
+        if (k->enable) {
+            float det = fmaxf(fabsf(left[i]), fabsf(right[i])) + DSP_COMP_FLOOR;
+            target = dsp_comp_gain_db(k, dsp_fast_lin_to_db(det));
+        }
+        // More reduction uses the attack time, less uses the release time
+        float a = (target < env) ? att : rel;
+        env = target + a * (env - target);
+
+        float g = dsp_fast_db_to_lin(env + dsp_smooth_next(&makeup));
+        left[i] *= g;
+        right[i] *= g;
+        if (env < peak) {
+            peak = env;
+        }
+    }
+
+    c->makeup_db = makeup;
+    c->env_db = env;
+    c->gr_db = env;
+    c->gr_peak_db = peak;
+}
+
+/**
+ * @brief Read the gain reduction telemetry and restart the peak hold (main loop)
+ * @param c Stage instance
+ * @param gr_db Current gain reduction in dB (<= 0)
+ * @param gr_peak_db Deepest gain reduction since the previous read
+ */
+void dsp_comp_read_gr(dsp_comp_t* c, float* gr_db, float* gr_peak_db)
+{
+    *gr_db = c->gr_db;
+    *gr_peak_db = c->gr_peak_db;
+    c->gr_peak_reset = true;
+}
@@ -0,0 +1,147 @@
+#include "dsp_hrtf.h"
+#include <string.h>
+
+#define DSP_HRTF_MASK  (DSP_HRTF_TAPS - 1U)
+
+/**
+ * @brief Initialize a virtualiser (off)
+ * @param h Stage instance, may live in CCM RAM (not zeroed at startup)
+ * @param fs Sample rate in Hz
+ */
+void dsp_hrtf_init(dsp_hrtf_t* h, float fs)
+{
+    memset(h, 0, sizeof(*h));
+    h->coef[0].set = DSP_HRTF_OFF;
+    h->coef[1] = h->coef[0];
+    h->running = DSP_HRTF_OFF;
+    dsp_smooth_init_linear(&h->mix, fs, DSP_HRTF_FADE_MS, 0.0f);
+    dsp_bank_init(&h->bank);
+}
+
+/**
+ * @brief Look up a set by name
+ * @return Set index, or DSP_HRTF_OFF if not found
+ */
+int8_t dsp_hrtf_find(const char* name)
+{
+    for (uint32_t i = 0; i < DSP_HRTF_SET_COUNT; i++) {
+        if (strcmp(dsp_hrtf_sets[i].name, name) == 0) {
+            return (int8_t)i;
+        }
+    }
+    return DSP_HRTF_OFF;
+}
+
+/**
+ * @brief Select a set (main loop)
+ * @param h Stage instance
+ * @param set Set index, or DSP_HRTF_OFF
+ * @return false if the set is invalid or the previous update is still pending
+ */
+bool dsp_hrtf_set(dsp_hrtf_t* h, int8_t set)
+{
+    if (set >= (int8_t)DSP_HRTF_SET_COUNT || set < DSP_HRTF_OFF || dsp_bank_pending(&h->bank)) {
+        return false;
+    }
+    h->coef[dsp_bank_staging(&h->bank)].set = set;
+    dsp_bank_publish(&h->bank);
+    return true;
+}
+
+/**
+ * @brief Selected set as last published
+ */
+int8_t dsp_hrtf_get(const dsp_hrtf_t* h)
+{
+    return h->coef[h->bank.next].set;
+}
+
+/**
+ * @brief Override one parameter at a chunk boundary (audio path, automation)
+ * @return false for an unknown parameter or set
+ */
+bool dsp_hrtf_set_param(dsp_hrtf_t* h, uint8_t param, float value)
+{
+    int32_t set = (int32_t)value;
+    if (param != DSP_HRTF_PARAM_SET || set < DSP_HRTF_OFF || set >= (int32_t)DSP_HRTF_SET_COUNT) {
+        return false;
+    }
+    dsp_override_set(&h->auto_set, (float)h->coef[h->bank.active].set, (float)set);
+    return true;
+}
+
+/**
+ * @brief Process one block in place
+ * @param h Stage instance
+ * @param left Left channel samples
+ * @param right Right channel samples
+ * @param frames Number of frames
+ */
+void dsp_hrtf_process(dsp_hrtf_t* h, float* left, float* right, uint32_t frames)
+{
+    int8_t want = (int8_t)dsp_override_apply(&h->auto_set, (float)h->coef[h->bank.active].set);
+
+    // Filters only swap while the stage is fully dry
+    if (h->running != want && dsp_smooth_settled(&h->mix) && h->mix.value == 0.0f) {
+        h->running = want;
+    }
+    dsp_smooth_set_target(&h->mix, (h->running == want && want != DSP_HRTF_OFF) ? 1.0f : 0.0f);
+
+    uint32_t pos = h->pos;
+    float* hs = h->hist_s;
+    float* hd = h->hist_d;
+
+    if (h->running == DSP_HRTF_OFF) {
+        // Transparent: keep the histories filled so switching on starts from real audio
+        for (uint32_t i = 0; i < frames; i++) {
+            pos = (pos - 1U) & DSP_HRTF_MASK;
+            float s = 0.5f * (left[i] + right[i]);
+            float d = 0.5f * (left[i] - right[i]);
+            hs[pos] = s;
+            hs[pos + DSP_HRTF_TAPS] = s;
+            hd[pos] = d;
+            hd[pos + DSP_HRTF_TAPS] = d;
+        }
+        h->pos = pos;
+        return;
+    }
+
+    const float* cs = dsp_hrtf_sets[h->running].sum;
+    const float* cd = dsp_hrtf_sets[h->running].diff;
+    bool fading = !dsp_smooth_settled(&h->mix);
+    dsp_smooth_t mix = h->mix;
+
+    for (uint32_t i = 0; i < frames; i++) {
+        pos = (pos - 1U) & DSP_HRTF_MASK;
+        float s = 0.5f * (left[i] + right[i]);
+        float d = 0.5f * (left[i] - right[i]);
+        hs[pos] = s;
+        hs[pos + DSP_HRTF_TAPS] = s;
+        hd[pos] = d;
+        hd[pos + DSP_HRTF_TAPS] = d;
+
+        // hs[pos + k] is the mid sample k frames back, no wrap inside the loop
+        const float* xs = &hs[pos];
+        const float* xd = &hd[pos];
+        float as0 = 0.0f, as1 = 0.0f, ad0 = 0.0f, ad1 = 0.0f;
+        for (uint32_t k = 0; k < DSP_HRTF_TAPS; k += 2U) {
+            as0 += cs[k] * xs[k];
+            ad0 += cd[k] * xd[k];
+            as1 += cs[k + 1U] * xs[k + 1U];
+            ad1 += cd[k + 1U] * xd[k + 1U];
+        }
+        float ys = as0 + as1;
+        float yd = ad0 + ad1;
+
+        if (fading) {
+            float m = dsp_smooth_next(&mix);
+            left[i]  += m * (ys + yd - left[i]);
+            right[i] += m * (ys - yd - right[i]);
+        } else {
+            left[i]  = ys + yd;
+            right[i] = ys - yd;
+        }
+    }
+    h->mix = mix;
+    h->pos = pos;
+}
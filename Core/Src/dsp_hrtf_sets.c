@@ -0,0 +1,97 @@
+// Generated by DSP_Host/hrtf_gen.py, do not edit
+// Brown-Duda spherical head, 64 taps at 48000 Hz, shuffler form (sum/diff)
+
+#include "dsp_hrtf.h"
+
+// +-30 deg speakers, ITD 12.5 samples
+static const float hrtf_30deg_sum[DSP_HRTF_TAPS] = {
+    0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f, 6.59701467e-01f, -2.40133847e-02f,
+    -2.03873266e-02f, -1.73088089e-02f, -1.46951521e-02f, -1.24977110e-02f, -1.03285661e-02f, -9.95642472e-03f,
+    -5.03181309e-03f, -1.24077166e-02f, 6.92826486e-03f, -3.15850142e-02f, 8.74674349e-02f, 1.32980970e-01f,
+    1.93351646e-02f, 4.83739271e-02f, 2.61416087e-02f, 2.90309203e-02f, 2.18597699e-02f, 1.94770863e-02f,
+    1.63415772e-02f, 1.38897238e-02f, 1.17923541e-02f, 1.00116904e-02f, 8.49990976e-03f, 7.21641029e-03f,
+    6.12672122e-03f, 5.20157687e-03f, 4.41613075e-03f, 3.74928820e-03f, 3.18313991e-03f, 2.70248088e-03f,
+    2.29440210e-03f, 1.94794385e-03f, 1.65380132e-03f, 1.40407478e-03f, 1.19205732e-03f, 1.01205483e-03f,
+    8.59232991e-04f, 7.29487485e-04f, 6.13383589e-04f, 5.05800819e-04f, 4.08797540e-04f, 3.23501386e-04f,
+    2.50271839e-04f, 1.88865234e-04f, 1.38591595e-04f, 9.84561992e-05f, 6.72817250e-05f, 4.38091476e-05f,
+    2.67773079e-05f, 1.49823518e-05f, 7.31906824e-06f, 2.80663493e-06f, 6.01485874e-07f, 0.00000000e+00f,
+    0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f,
+};
+
+static const float hrtf_30deg_diff[DSP_HRTF_TAPS] = {
+    0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f, 6.59701467e-01f, -2.40133847e-02f,
+    -2.03873266e-02f, -1.73088089e-02f, -1.46951521e-02f, -1.24546119e-02f, -1.08559176e-02f, -8.02916931e-03f,
+    -1.02379285e-02f, -5.56270497e-04f, -1.79346699e-02f, 2.22405932e-02f, -9.54008339e-02f, -1.39716414e-01f,
+    -2.50535457e-02f, -5.32288239e-02f, -3.02634086e-02f, -3.25303220e-02f, -2.48307566e-02f, -2.19994494e-02f,
+    -1.84830596e-02f, -1.57078390e-02f, -1.33359311e-02f, -1.13221850e-02f, -9.61251761e-03f, -8.16101264e-03f,
+    -6.92868716e-03f, -5.88244472e-03f, -4.99418650e-03f, -4.24005665e-03f, -3.59980156e-03f, -3.05622598e-03f,
+    -2.59473115e-03f, -2.20292275e-03f, -1.87027802e-03f, -1.58786315e-03f, -1.34809337e-03f, -1.14452919e-03f,
+    -9.71703523e-04f, -8.24974794e-04f, -6.93673312e-04f, -5.72008342e-04f, -4.62307679e-04f, -3.65846563e-04f,
+    -2.83031529e-04f, -2.13587019e-04f, -1.56732741e-04f, -1.11343764e-04f, -7.60886627e-05f, -4.95436087e-05f,
+    -3.02823619e-05f, -1.69434882e-05f, -8.27710816e-06f, -3.17401342e-06f, -6.80218228e-07f, 0.00000000e+00f,
+    0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f,
+};
+
+// +-45 deg speakers, ITD 18.3 samples
+static const float hrtf_45deg_sum[DSP_HRTF_TAPS] = {
+    0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f, 7.58027409e-01f, -4.12049912e-02f,
+    -3.49829740e-02f, -2.97004910e-02f, -2.52156711e-02f, -2.14080659e-02f, -1.81754150e-02f, -1.54308993e-02f,
+    -1.31008097e-02f, -1.11225673e-02f, -9.44304249e-03f, -8.04267837e-03f, -6.63315625e-03f, -6.32811549e-03f,
+    -3.51955603e-03f, -7.19593769e-03f, 2.75838289e-03f, -1.74124096e-02f, 7.97912490e-02f, 7.54109975e-02f,
+    4.27167400e-02f, 4.52646057e-02f, 3.41963986e-02f, 3.08965386e-02f, 2.55264529e-02f, 2.18726438e-02f,
+    1.85407292e-02f, 1.57420164e-02f, 1.33649477e-02f, 1.13468200e-02f, 9.63343267e-03f, 8.17876949e-03f,
+    6.94376270e-03f, 5.89524383e-03f, 5.00505293e-03f, 4.24928222e-03f, 3.60763406e-03f, 3.06287576e-03f,
+    2.60037680e-03f, 2.20771590e-03f, 1.85633986e-03f, 1.53075211e-03f, 1.23718206e-03f, 9.79042364e-04f,
+    7.57420967e-04f, 5.71580443e-04f, 4.19432649e-04f, 2.97967163e-04f, 2.03620949e-04f, 1.32583702e-04f,
+    8.10386599e-05f, 4.53424863e-05f, 2.21503777e-05f, 8.49398060e-06f, 1.82033270e-06f, 0.00000000e+00f,
+    0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f,
+};
+
+static const float hrtf_45deg_diff[DSP_HRTF_TAPS] = {
+    0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f, 7.58027409e-01f, -4.12049912e-02f,
+    -3.49829740e-02f, -2.97004910e-02f, -2.52156711e-02f, -2.14080659e-02f, -1.81754150e-02f, -1.54308993e-02f,
+    -1.31008097e-02f, -1.11225673e-02f, -9.44304249e-03f, -7.99157867e-03f, -6.97990328e-03f, -5.22935107e-03f,
+    -6.29271528e-03f, -1.13466552e-03f, -9.83105219e-03f, 1.14077243e-02f, -8.48892176e-02f, -7.97391650e-02f,
+    -4.63913476e-02f, -4.83843418e-02f, -3.68450498e-02f, -3.31452393e-02f, -2.74355963e-02f, -2.34935037e-02f,
+    -1.99168368e-02f, -1.69103296e-02f, -1.43568437e-02f, -1.21889382e-02f, -1.03483898e-02f, -8.78576696e-03f,
+    -7.45910261e-03f, -6.33276663e-03f, -5.37650911e-03f, -4.56464795e-03f, -3.87537907e-03f, -3.29019086e-03f,
+    -2.79336697e-03f, -2.37156426e-03f, -1.99411042e-03f, -1.64435877e-03f, -1.32900105e-03f, -1.05170320e-03f,
+    -8.13633899e-04f, -6.14000991e-04f, -4.50561360e-04f, -3.20081163e-04f, -2.18732929e-04f, -1.42423565e-04f,
+    -8.70530441e-05f, -4.87076349e-05f, -2.37942953e-05f, -9.12437185e-06f, -1.95543094e-06f, 0.00000000e+00f,
+    0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f,
+};
+
+// +-60 deg speakers, ITD 23.4 samples
+static const float hrtf_60deg_sum[DSP_HRTF_TAPS] = {
+    0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f, 8.07250607e-01f, -5.25093600e-02f,
+    -4.45803657e-02f, -3.78486618e-02f, -3.21334556e-02f, -2.72812543e-02f, -2.31617428e-02f, -1.96642840e-02f,
+    -1.66949468e-02f, -1.41739841e-02f, -1.20336907e-02f, -1.02165848e-02f, -8.67386478e-03f, -7.36409784e-03f,
+    -6.25210772e-03f, -5.30802982e-03f, -4.52144298e-03f, -3.69306767e-03f, -3.67643054e-03f, -1.65778108e-03f,
+    -4.75751403e-03f, 3.01931240e-03f, -1.28401196e-02f, 4.59461503e-02f, 7.43347802e-02f, 4.59900505e-02f,
+    4.64107004e-02f, 3.59257210e-02f, 3.20272333e-02f, 2.66192546e-02f, 2.27586930e-02f, 1.93025184e-02f,
+    1.63886242e-02f, 1.39139167e-02f, 1.18128938e-02f, 1.00291287e-02f, 8.51471479e-03f, 7.22897974e-03f,
+    6.13739266e-03f, 5.21063691e-03f, 4.38132145e-03f, 3.61287133e-03f, 2.91998916e-03f, 2.31072951e-03f,
+    1.78766011e-03f, 1.34904050e-03f, 9.89942249e-04f, 7.03260188e-04f, 4.80584858e-04f, 3.12923205e-04f,
+    1.91266926e-04f, 1.07017046e-04f, 5.22791794e-05f, 2.00474386e-05f, 4.29633758e-06f, 0.00000000e+00f,
+    0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f,
+};
+
+static const float hrtf_60deg_diff[DSP_HRTF_TAPS] = {
+    0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f, 8.07250607e-01f, -5.25093600e-02f,
+    -4.45803657e-02f, -3.78486618e-02f, -3.21334556e-02f, -2.72812543e-02f, -2.31617428e-02f, -1.96642840e-02f,
+    -1.66949468e-02f, -1.41739841e-02f, -1.20336907e-02f, -1.02165848e-02f, -8.67386478e-03f, -7.36409784e-03f,
+    -6.25210772e-03f, -5.30802982e-03f, -4.49157529e-03f, -3.95897096e-03f, -2.82013846e-03f, -3.85779599e-03f,
+    7.47975928e-05f, -6.99493144e-03f, 9.46482519e-03f, -4.88117701e-02f, -7.67676870e-02f, -4.80555846e-02f,
+    -4.81643357e-02f, -3.74145546e-02f, -3.32912507e-02f, -2.76924035e-02f, -2.36697948e-02f, -2.00760423e-02f,
+    -1.70453449e-02f, -1.44714715e-02f, -1.22862570e-02f, -1.04310133e-02f, -8.85591422e-03f, -7.51865752e-03f,
+    -6.38332865e-03f, -5.41943619e-03f, -4.55688862e-03f, -3.75764536e-03f, -3.03699820e-03f, -2.40332446e-03f,
+    -1.85929476e-03f, -1.40309890e-03f, -1.02961096e-03f, -7.31441046e-04f, -4.99842729e-04f, -3.25462582e-04f,
+    -1.98931324e-04f, -1.11305405e-04f, -5.43740971e-05f, -2.08507743e-05f, -4.46849929e-06f, 0.00000000e+00f,
+    0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f, 0.00000000e+00f,
+};
+
+const dsp_hrtf_set_t dsp_hrtf_sets[DSP_HRTF_SET_COUNT] = {
+    { "30deg", hrtf_30deg_sum, hrtf_30deg_diff },
+    { "45deg", hrtf_45deg_sum, hrtf_45deg_diff },
+    { "60deg", hrtf_60deg_sum, hrtf_60deg_diff },
+};
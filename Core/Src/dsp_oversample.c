@@ -0,0 +1,199 @@
+#include "dsp_oversample.h"
+#include <math.h>
+#include <string.h>
+
+#define DSP_OS_KAISER_BETA  7.0f   // About -70 dB stop band
+#define DSP_OS_PI           3.14159265358979f
+
+// Side taps nearest the centre first, shared by all instances
+static float hb_2x[DSP_OS_PAIRS_2X];
+static float hb_4x[DSP_OS_PAIRS_4X];
+static bool tables_ready = false;
+
+/**
+ * @brief Zeroth-order modified Bessel function (series), for the Kaiser window
+ */
+static float dsp_os_bessel_i0(float x)
+{
+    float sum = 1.0f;
+    float term = 1.0f;
+    for (uint32_t k = 1; k < 20U; k++) {
+        term *= (x / (2.0f * (float)k)) * (x / (2.0f * (float)k));
+        sum += term;
+    }
+    return sum;
+}
+
+/**
+ * @brief Kaiser-windowed half-band design, side taps normalised for unity DC gain
+ * @param h Output, pairs side taps (h[0] at distance 1 from the centre, h[j] at 2j+1)
+ */
+static void dsp_os_design(float* h, uint32_t pairs)
+{
+    float half_len = (float)(2U * pairs);   // Taps span centre +- (2 * pairs - 1)
+    float norm = dsp_os_bessel_i0(DSP_OS_KAISER_BETA);
+    float sum = 0.0f;
+
+    for (uint32_t j = 0; j < pairs; j++) {
+        float d = (float)(2U * j + 1U);
+        float sinc = sinf(0.5f * DSP_OS_PI * d) / (DSP_OS_PI * d);
+        float r = d / half_len;
+        float w = dsp_os_bessel_i0(DSP_OS_KAISER_BETA * sqrtf(1.0f - r * r)) / norm;
+        h[j] = sinc * w;
+        sum += h[j];
+    }
+    // Centre tap is 0.5, each side must add up to 0.25
+    for (uint32_t j = 0; j < pairs; j++) {
+        h[j] *= 0.25f / sum;
+    }
+}
+
+/**
+ * @brief Interpolate one channel by 2: in[n] -> out[2n], out[2n+1]
+ * @param k Number of side-tap pairs, a constant at every call site so the tap loop unrolls
+ */
+static inline void dsp_hb_up_process(dsp_oversample_t* os, dsp_hb_up_t* f, const float* h, const uint32_t k,
+                                     const float* in, float* out, uint32_t n)
+{
+    float* up_buf = os->scratch;
+    const uint32_t hist = 2U * k - 1U;
+
+    memcpy(up_buf, f->hist, hist * sizeof(float));
+    memcpy(&up_buf[hist], in, n * sizeof(float));
+
+    for (uint32_t i = 0; i < n; i++) {
+        const float* x = &up_buf[hist + i];   // x[0] = newest, x[-d] = d samples ago
+        float acc = 0.0f;
+        for (uint32_t j = 0; j < k; j++) {
+            acc += h[j] * (x[-(int32_t)(k - 1U - j)] + x[-(int32_t)(k + j)]);
+        }
+        out[2U * i]      = 2.0f * acc;
+        out[2U * i + 1U] = x[-(int32_t)(k - 1U)];
+    }
+
+    memcpy(f->hist, &up_buf[n], hist * sizeof(float));
+}
+
+/**
+ * @brief Decimate one channel by 2: in[2n], in[2n+1] -> out[n]
+ * @param k Number of side-tap pairs, a constant at every call site
+ */
+static inline void dsp_hb_down_process(dsp_oversample_t* os, dsp_hb_down_t* f, const float* h, const uint32_t k,
+                                       const float* in, float* out, uint32_t n)
+{
+    float* even_buf = os->scratch;
+    float* odd_buf = os->scratch_odd;
+    const uint32_t ehist = 2U * k - 1U;
+
+    memcpy(even_buf, f->even_hist, ehist * sizeof(float));
+    memcpy(odd_buf, f->odd_hist, k * sizeof(float));
+    for (uint32_t i = 0; i < n; i++) {
+        even_buf[ehist + i] = in[2U * i];
+        odd_buf[k + i] = in[2U * i + 1U];
+    }
+
+    for (uint32_t i = 0; i < n; i++) {
+        const float* e = &even_buf[ehist + i];
+        float acc = 0.5f * odd_buf[i];         // o[n - k]
+        for (uint32_t j = 0; j < k; j++) {
+            acc += h[j] * (e[-(int32_t)(k - 1U - j)] + e[-(int32_t)(k + j)]);
+        }
+        out[i] = acc;
+    }
+
+    memcpy(f->even_hist, &even_buf[n], ehist * sizeof(float));
+    memcpy(f->odd_hist, &odd_buf[n], k * sizeof(float));
+}
+
+/**
+ * @brief Clear the filter histories
+ */
+void dsp_oversample_reset(dsp_oversample_t* os)
+{
+    for (uint32_t s = 0; s < 2U; s++) {
+        for (uint32_t c = 0; c < 2U; c++) {
+            memset(os->up[s][c].hist, 0, sizeof(os->up[s][c].hist));
+            memset(os->down[s][c].even_hist, 0, sizeof(os->down[s][c].even_hist));
+            memset(os->down[s][c].odd_hist, 0, sizeof(os->down[s][c].odd_hist));
+        }
+    }
+}
+
+/**
+ * @brief Initialize an oversampler
+ * @param os Instance
+ * @param factor 1 (pass-through), 2 or 4, other values select 1
+ */
+void dsp_oversample_init(dsp_oversample_t* os, uint8_t factor)
+{
+    if (!tables_ready) {
+        dsp_os_design(hb_2x, DSP_OS_PAIRS_2X);
+        dsp_os_design(hb_4x, DSP_OS_PAIRS_4X);
+        tables_ready = true;
+    }
+    memset(os, 0, sizeof(*os));
+    os->factor = (factor == 2U || factor == 4U) ? factor : 1U;
+}
+
+/**
+ * @brief Added latency in base-rate samples (may be fractional at 4x)
+ */
+float dsp_oversample_latency(const dsp_oversample_t* os)
+{
+    // Each half-band pair (up + down) delays by 2 * (2K - 1) samples at its high rate
+    float lat = 0.0f;
+    if (os->factor >= 2U) {
+        lat += (float)(2U * DSP_OS_PAIRS_2X - 1U);
+    }
+    if (os->factor >= 4U) {
+        lat += (float)(2U * DSP_OS_PAIRS_4X - 1U) / 2.0f;
+    }
+    return lat;
+}
+
+/**
+ * @brief Run a function at the oversampled rate on a stereo block in place
+ * @param os Instance
+ * @param fn Function to run at factor * fs
+ * @param state Passed to fn
+ * @param left Left channel samples
+ * @param right Right channel samples
+ * @param frames Number of base-rate frames
+ */
+void dsp_oversample_process(dsp_oversample_t* os, dsp_os_fn_t fn, void* state,
+                            float* left, float* right, uint32_t frames)
+{
+    if (os->factor == 1U) {
+        fn(state, left, right, frames);
+        return;
+    }
+
+    while (frames > 0) {
+        uint32_t n = (frames > DSP_OS_MAX_FRAMES) ? DSP_OS_MAX_FRAMES : frames;
+
+        if (os->factor == 2U) {
+            dsp_hb_up_process(os, &os->up[0][0], hb_2x, DSP_OS_PAIRS_2X, left, os->work_l, n);
+            dsp_hb_up_process(os, &os->up[0][1], hb_2x, DSP_OS_PAIRS_2X, right, os->work_r, n);
+            fn(state, os->work_l, os->work_r, 2U * n);
+            dsp_hb_down_process(os, &os->down[0][0], hb_2x, DSP_OS_PAIRS_2X, os->work_l, left, n);
+            dsp_hb_down_process(os, &os->down[0][1], hb_2x, DSP_OS_PAIRS_2X, os->work_r, right, n);
+        } else {
+            // 1x -> 2x into the upper half of the work buffer, then 2x -> 4x in place from the front
+            float* mid_l = &os->work_l[2U * DSP_OS_MAX_FRAMES];
+            float* mid_r = &os->work_r[2U * DSP_OS_MAX_FRAMES];
+            dsp_hb_up_process(os, &os->up[0][0], hb_2x, DSP_OS_PAIRS_2X, left, mid_l, n);
+            dsp_hb_up_process(os, &os->up[0][1], hb_2x, DSP_OS_PAIRS_2X, right, mid_r, n);
+            dsp_hb_up_process(os, &os->up[1][0], hb_4x, DSP_OS_PAIRS_4X, mid_l, os->work_l, 2U * n);
+            dsp_hb_up_process(os, &os->up[1][1], hb_4x, DSP_OS_PAIRS_4X, mid_r, os->work_r, 2U * n);
+            fn(state, os->work_l, os->work_r, 4U * n);
+            dsp_hb_down_process(os, &os->down[1][0], hb_4x, DSP_OS_PAIRS_4X, os->work_l, mid_l, 2U * n);
+            dsp_hb_down_process(os, &os->down[1][1], hb_4x, DSP_OS_PAIRS_4X, os->work_r, mid_r, 2U * n);
+            dsp_hb_down_process(os, &os->down[0][0], hb_2x, DSP_OS_PAIRS_2X, mid_l, left, n);
+            dsp_hb_down_process(os, &os->down[0][1], hb_2x, DSP_OS_PAIRS_2X, mid_r, right, n);
+        }
+
+        left += n;
+        right += n;
+        frames -= n;
+    }
+}
@@ -0,0 +1,131 @@
+#include "dsp_peq.h"
+#include <math.h>
+#include <string.h>
+
+/**
+ * @brief Initialize an empty cascade (transparent)
+ * @param p Stage instance
+ * @param fs Sample rate in Hz
+ */
+void dsp_peq_init(dsp_peq_t* p, float fs)
+{
+    memset(p, 0, sizeof(*p));
+    p->coef[0].preamp = 1.0f;
+    p->coef[1] = p->coef[0];
+    dsp_smooth_init_one_pole(&p->preamp, fs, DSP_PEQ_SMOOTH_MS, 1.0f);
+    dsp_bank_init(&p->bank);
+}
+
+/**
+ * @brief Check that a section is finite and has both poles inside DSP_PEQ_POLE_MAX
+ *
+ * For z^2 + a1 z + a2 the poles lie inside the unit circle when
+ * |a2| < 1 and |a1| < 1 + a2. Scaling z by r gives the test for radius r:
+ * |a2| < r^2 and |a1| < r + a2 / r, which bounds real poles as well.
+ */
+bool dsp_peq_section_valid(const dsp_biquad_coef_t* c)
+{
+    const float v[5] = { c->b0, c->b1, c->b2, c->a1, c->a2 };
+    for (uint32_t i = 0; i < 5U; i++) {
+        if (!isfinite(v[i])) {
+            return false;
+        }
+    }
+    if (fabsf(c->b0) > DSP_PEQ_COEF_MAX || fabsf(c->b1) > DSP_PEQ_COEF_MAX || fabsf(c->b2) > DSP_PEQ_COEF_MAX) {
+        return false;
+    }
+    const float r = DSP_PEQ_POLE_MAX;
+    return fabsf(c->a2) < r * r && fabsf(c->a1) < r + c->a2 / r;
+}
+
+/**
+ * @brief Replace the whole cascade in one update (main loop)
+ * @param p Stage instance
+ * @param sec Section coefficients, validated with dsp_peq_section_valid()
+ * @param count Number of sections (0..DSP_PEQ_MAX_SECTIONS)
+ * @param preamp_db Gain applied before the sections (DSP_PEQ_PREAMP_MIN_DB..DSP_PEQ_PREAMP_MAX_DB)
+ * @return false if the set is invalid or the previous update is still pending
+ */
+bool dsp_peq_load(dsp_peq_t* p, const dsp_biquad_coef_t* sec, uint8_t count, float preamp_db)
+{
+    if (count > DSP_PEQ_MAX_SECTIONS || !(preamp_db >= DSP_PEQ_PREAMP_MIN_DB && preamp_db <= DSP_PEQ_PREAMP_MAX_DB)
+            || dsp_bank_pending(&p->bank)) {
+        return false;
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        if (!dsp_peq_section_valid(&sec[i])) {
+            return false;
+        }
+    }
+    dsp_peq_coef_t* k = &p->coef[dsp_bank_staging(&p->bank)];
+    k->count = count;
+    k->preamp = powf(10.0f, preamp_db / 20.0f);
+    memcpy(k->sec, sec, count * sizeof(dsp_biquad_coef_t));
+    dsp_bank_publish(&p->bank);
+    return true;
+}
+
+/**
+ * @brief Number of sections as last published
+ */
+uint8_t dsp_peq_count(const dsp_peq_t* p)
+{
+    return p->coef[p->bank.next].count;
+}
+
+/**
+ * @brief Override one parameter at a chunk boundary (audio path, automation)
+ * @return false for an unknown parameter
+ */
+bool dsp_peq_set_param(dsp_peq_t* p, uint8_t param, float value)
+{
+    if (param != DSP_PEQ_PARAM_PREAMP_DB) {
+        return false;
+    }
+    if (value < DSP_PEQ_PREAMP_MIN_DB) value = DSP_PEQ_PREAMP_MIN_DB;
+    if (value > DSP_PEQ_PREAMP_MAX_DB) value = DSP_PEQ_PREAMP_MAX_DB;
+    dsp_override_set(&p->auto_preamp, p->coef[p->bank.active].preamp, powf(10.0f, value / 20.0f));
+    return true;
+}
+
+/**
+ * @brief Process one block in place
+ * @param p Stage instance
+ * @param left Left channel samples
+ * @param right Right channel samples
+ * @param frames Number of frames
+ */
+void dsp_peq_process(dsp_peq_t* p, float* left, float* right, uint32_t frames)
+{
+    const dsp_peq_coef_t* k = &p->coef[p->bank.active];
+
+    // Sections that were idle start from a clean state
+    for (uint8_t i = p->running; i < k->count; i++) {
+        dsp_biquad_reset(&p->st[0][i]);
+        dsp_biquad_reset(&p->st[1][i]);
+    }
+    p->running = k->count;
+
+    dsp_smooth_set_target(&p->preamp, dsp_override_apply(&p->auto_preamp, k->preamp));
+    if (dsp_smooth_settled(&p->preamp)) {
+        if (p->preamp.value != 1.0f) {
+            float g = p->preamp.value;
+            for (uint32_t i = 0; i < frames; i++) {
+                left[i] *= g;
+                right[i] *= g;
+            }
+        }
+    } else {
+        for (uint32_t i = 0; i < frames; i++) {
+            float g = dsp_smooth_next(&p->preamp);
+            left[i] *= g;
+            right[i] *= g;
+        }
+    }
+
+    // Section by section keeps the coefficients in registers for the whole block
+    for (uint8_t s = 0; s < k->count; s++) {
+        dsp_biquad_process(&k->sec[s], &p->st[0][s], left, frames);
+        dsp_biquad_process(&k->sec[s], &p->st[1][s], right, frames);
+    }
+}
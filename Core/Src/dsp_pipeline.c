@@ -0,0 +1,438 @@
+#include "dsp_pipeline.h"
+#include "perf.h"
+#include <string.h>
+
+// Stage registry
+static dsp_stage_t stages[DSP_PIPELINE_MAX_STAGES];
+static uint8_t stage_count = 0;
+
+// Double-buffered chain: the audio path runs chains[active_chain], the main
+// loop edits the other copy and publishes it by writing next_chain. The audio
+// path adopts it at the start of its next block.
+static dsp_chain_t chains[2];
+static volatile uint8_t active_chain = 0;
+static volatile uint8_t next_chain = 0;
+
+// Frames that entered the chain since init, the time base of automation events
+static volatile uint32_t frame_pos = 0;
+
+// Dry copy for bypass cross-fades
+static float dry_l[DSP_PIPELINE_MAX_FRAMES];
+static float dry_r[DSP_PIPELINE_MAX_FRAMES];
+
+/**
+ * @brief Reset the registry and the chain
+ */
+void dsp_pipeline_init(void)
+{
+    memset(stages, 0, sizeof(stages));
+    memset(chains, 0, sizeof(chains));
+    stage_count = 0;
+    active_chain = 0;
+    next_chain = 0;
+    frame_pos = 0;
+    dsp_auto_init();
+}
+
+/**
+ * @brief Register a stage instance, it is not part of the chain until inserted
+ * @param name Unique stage name used by the shell
+ * @param process Process function
+ * @param state Instance passed to the process function
+ * @param bank Coefficient bank of the instance, or NULL if it has none
+ * @return Stage index, or -1 if the registry is full
+ */
+int8_t dsp_pipeline_register(const char* name, dsp_stage_fn_t process, void* state, dsp_bank_t* bank)
+{
+    if (stage_count >= DSP_PIPELINE_MAX_STAGES || !name || !process) {
+        return -1;
+    }
+    stages[stage_count].name = name;
+    stages[stage_count].process = process;
+    stages[stage_count].state = state;
+    stages[stage_count].bank = bank;
+    stages[stage_count].os = NULL;
+    stages[stage_count].set_param = NULL;
+    stages[stage_count].auto_bypass = false;
+    stages[stage_count].wet = 0.0f;
+    stages[stage_count].perf_id = perf_register(name);
+    return (int8_t)stage_count++;
+}
+
+/**
+ * @brief Look up a registered stage by name
+ * @return Stage index, or -1 if not found
+ */
+int8_t dsp_pipeline_find(const char* name)
+{
+    for (uint8_t i = 0; i < stage_count; i++) {
+        if (strcmp(stages[i].name, name) == 0) {
+            return (int8_t)i;
+        }
+    }
+    return -1;
+}
+
+uint8_t dsp_pipeline_stage_count(void)
+{
+    return stage_count;
+}
+
+const char* dsp_pipeline_stage_name(uint8_t stage)
+{
+    return (stage < stage_count) ? stages[stage].name : "?";
+}
+
+/**
+ * @brief Run a registered stage through an oversampler (setup only, before the stage is inserted)
+ * @param stage Stage index
+ * @param os Oversampler whose factor the stage was initialised for, or NULL for the base rate
+ * @return DSP_PIPELINE_OK or DSP_PIPELINE_INVALID
+ */
+uint8_t dsp_pipeline_set_oversample(uint8_t stage, dsp_oversample_t* os)
+{
+    if (stage >= stage_count) {
+        return DSP_PIPELINE_INVALID;
+    }
+    stages[stage].os = os;
+    return DSP_PIPELINE_OK;
+}
+
+/**
+ * @brief Give a registered stage an automation setter (setup only)
+ * @param stage Stage index
+ * @param fn Parameter setter, called in the audio path with the stage state
+ * @return DSP_PIPELINE_OK or DSP_PIPELINE_INVALID
+ */
+uint8_t dsp_pipeline_set_param_fn(uint8_t stage, dsp_param_fn_t fn)
+{
+    if (stage >= stage_count) {
+        return DSP_PIPELINE_INVALID;
+    }
+    stages[stage].set_param = fn;
+    return DSP_PIPELINE_OK;
+}
+
+/**
+ * @brief Latency a stage adds, in samples at the base rate
+ */
+float dsp_pipeline_stage_latency(uint8_t stage)
+{
+    if (stage >= stage_count || !stages[stage].os) {
+        return 0.0f;
+    }
+    return dsp_oversample_latency(stages[stage].os);
+}
+
+/**
+ * @brief Total latency of the published chain, in samples at the base rate
+ *
+ * Bypassed stages are skipped, so the figure changes when an oversampled
+ * stage is bypassed; callers that align other paths should re-read it.
+ */
+float dsp_pipeline_latency(void)
+{
+    const dsp_chain_t* ch = &chains[next_chain];
+    float lat = 0.0f;
+    for (uint8_t i = 0; i < ch->count; i++) {
+        if (!ch->slots[i].bypass) {
+            lat += dsp_pipeline_stage_latency(ch->slots[i].stage);
+        }
+    }
+    return lat;
+}
+
+bool dsp_pipeline_pending(void)
+{
+    return next_chain != active_chain;
+}
+
+/**
+ * @brief Adopt a published chain from the main loop, only while the audio path is stopped
+ *
+ * No audio runs across this swap, so stages take their final wet level at
+ * once: the boot chain starts fully wet, only stages inserted or bypassed
+ * while streaming fade.
+ */
+void dsp_pipeline_apply_pending(void)
+{
+    active_chain = next_chain;
+    const dsp_chain_t* ch = &chains[active_chain];
+    for (uint8_t s = 0; s < stage_count; s++) {
+        stages[s].wet = 0.0f;
+    }
+    for (uint8_t i = 0; i < ch->count; i++) {
+        dsp_stage_t* st = &stages[ch->slots[i].stage];
+        st->wet = (ch->slots[i].bypass || st->auto_bypass) ? 0.0f : 1.0f;
+    }
+}
+
+/**
+ * @brief Copy the chain as last published
+ */
+void dsp_pipeline_get_chain(dsp_chain_t* out)
+{
+    *out = chains[next_chain];
+}
+
+/**
+ * @brief Start an edit on the inactive chain copy
+ * @return Chain to edit, or NULL if the previous change is still pending
+ */
+static dsp_chain_t* dsp_pipeline_begin(void)
+{
+    if (dsp_pipeline_pending()) {
+        return NULL;
+    }
+    uint8_t staging = active_chain ^ 1U;
+    chains[staging] = chains[active_chain];
+    return &chains[staging];
+}
+
+/**
+ * @brief Publish the edited chain, picked up at the next block boundary
+ */
+static void dsp_pipeline_publish(void)
+{
+    next_chain = active_chain ^ 1U;
+}
+
+/**
+ * @brief Insert a registered stage into the chain
+ * @param stage Stage index
+ * @param pos Position (clamped to the end of the chain)
+ * @return DSP_PIPELINE_OK, DSP_PIPELINE_BUSY or DSP_PIPELINE_INVALID
+ */
+uint8_t dsp_pipeline_insert(uint8_t stage, uint8_t pos)
+{
+    if (stage >= stage_count) {
+        return DSP_PIPELINE_INVALID;
+    }
+    dsp_chain_t* ch = dsp_pipeline_begin();
+    if (!ch) {
+        return DSP_PIPELINE_BUSY;
+    }
+    if (ch->count >= DSP_PIPELINE_MAX_STAGES) {
+        return DSP_PIPELINE_INVALID;
+    }
+    // A stage instance owns its filter state, it may only run once per block
+    for (uint8_t i = 0; i < ch->count; i++) {
+        if (ch->slots[i].stage == stage) {
+            return DSP_PIPELINE_INVALID;
+        }
+    }
+    if (pos > ch->count) {
+        pos = ch->count;
+    }
+    for (uint8_t i = ch->count; i > pos; i--) {
+        ch->slots[i] = ch->slots[i - 1];
+    }
+    ch->slots[pos].stage = stage;
+    ch->slots[pos].bypass = false;
+    ch->count++;
+    dsp_pipeline_publish();
+    return DSP_PIPELINE_OK;
+}
+
+/**
+ * @brief Remove the stage at a chain position
+ */
+uint8_t dsp_pipeline_remove(uint8_t pos)
+{
+    dsp_chain_t* ch = dsp_pipeline_begin();
+    if (!ch) {
+        return DSP_PIPELINE_BUSY;
+    }
+    if (pos >= ch->count) {
+        return DSP_PIPELINE_INVALID;
+    }
+    for (uint8_t i = pos; i + 1U < ch->count; i++) {
+        ch->slots[i] = ch->slots[i + 1U];
+    }
+    ch->count--;
+    dsp_pipeline_publish();
+    return DSP_PIPELINE_OK;
+}
+
+/**
+ * @brief Move the stage at one chain position to another
+ */
+uint8_t dsp_pipeline_move(uint8_t from, uint8_t to)
+{
+    dsp_chain_t* ch = dsp_pipeline_begin();
+    if (!ch) {
+        return DSP_PIPELINE_BUSY;
+    }
+    if (from >= ch->count || to >= ch->count) {
+        return DSP_PIPELINE_INVALID;
+    }
+    dsp_slot_t slot = ch->slots[from];
+    if (from < to) {
+        for (uint8_t i = from; i < to; i++) {
+            ch->slots[i] = ch->slots[i + 1U];
+        }
+    } else {
+        for (uint8_t i = from; i > to; i--) {
+            ch->slots[i] = ch->slots[i - 1U];
+        }
+    }
+    ch->slots[to] = slot;
+    dsp_pipeline_publish();
+    return DSP_PIPELINE_OK;
+}
+
+/**
+ * @brief Bypass or re-enable the stage at a chain position (cross-faded over DSP_PIPELINE_FADE_FRAMES)
+ */
+uint8_t dsp_pipeline_bypass(uint8_t pos, bool bypass)
+{
+    dsp_chain_t* ch = dsp_pipeline_begin();
+    if (!ch) {
+        return DSP_PIPELINE_BUSY;
+    }
+    if (pos >= ch->count) {
+        return DSP_PIPELINE_INVALID;
+    }
+    ch->slots[pos].bypass = bypass;
+    dsp_pipeline_publish();
+    return DSP_PIPELINE_OK;
+}
+
+/**
+ * @brief Index of the next frame to enter the chain
+ */
+uint32_t dsp_pipeline_frame(void)
+{
+    return frame_pos;
+}
+
+bool dsp_pipeline_auto_bypassed(uint8_t stage)
+{
+    return stage < stage_count && stages[stage].auto_bypass;
+}
+
+/**
+ * @brief Apply one due automation event (audio path)
+ */
+static bool dsp_pipeline_apply_event(const dsp_auto_event_t* ev)
+{
+    if (ev->stage >= stage_count) {
+        return false;
+    }
+    dsp_stage_t* st = &stages[ev->stage];
+    if (ev->param == DSP_AUTO_PARAM_BYPASS) {
+        st->auto_bypass = (ev->value != 0.0f);
+        return true;
+    }
+    return st->set_param && st->set_param(st->state, ev->param, ev->value);
+}
+
+/**
+ * @brief Adopt a newly published chain, stages that left it restart from dry
+ */
+static void dsp_pipeline_swap(void)
+{
+    uint8_t idx = next_chain;
+    const dsp_chain_t* ch = &chains[idx];
+
+    for (uint8_t s = 0; s < stage_count; s++) {
+        bool present = false;
+        for (uint8_t i = 0; i < ch->count; i++) {
+            if (ch->slots[i].stage == s) {
+                present = true;
+                break;
+            }
+        }
+        if (!present) {
+            stages[s].wet = 0.0f;
+        }
+    }
+    active_chain = idx;
+}
+
+/**
+ * @brief Call a stage's process function, oversampled if it opted in
+ */
+static inline void dsp_pipeline_call(dsp_stage_t* st, float* left, float* right, uint32_t n)
+{
+    if (st->os) {
+        dsp_oversample_process(st->os, st->process, st->state, left, right, n);
+    } else {
+        st->process(st->state, left, right, n);
+    }
+}
+
+/**
+ * @brief Run one stage on a chunk, cross-fading when its bypass state changed
+ */
+static void dsp_pipeline_run_stage(dsp_stage_t* st, bool bypass, float* left, float* right, uint32_t n)
+{
+    float target = bypass ? 0.0f : 1.0f;
+    uint32_t start;
+
+    if (st->wet == target) {
+        if (!bypass) {
+            start = perf_cycles();
+            dsp_pipeline_call(st, left, right, n);
+            perf_record(st->perf_id, perf_cycles() - start);
+        }
+        return;
+    }
+
+    // Linear dry/wet ramp at a fixed rate, so chunks split by automation
+    // continue the fade instead of compressing it into a step
+    memcpy(dry_l, left, n * sizeof(float));
+    memcpy(dry_r, right, n * sizeof(float));
+    start = perf_cycles();
+    dsp_pipeline_call(st, left, right, n);
+    perf_record(st->perf_id, perf_cycles() - start);
+
+    float wet = st->wet;
+    const float step = (target > wet ? 1.0f : -1.0f) / (float)DSP_PIPELINE_FADE_FRAMES;
+    for (uint32_t i = 0; i < n; i++) {
+        wet += step;
+        if ((step > 0.0f) ? (wet > target) : (wet < target)) {
+            wet = target;
+        }
+        left[i]  = dry_l[i] + wet * (left[i] - dry_l[i]);
+        right[i] = dry_r[i] + wet * (right[i] - dry_r[i]);
+    }
+    st->wet = wet;
+}
+
+/**
+ * @brief Run the chain on one block in place (audio interrupt context)
+ * @param left Left channel samples
+ * @param right Right channel samples
+ * @param frames Number of frames
+ */
+void dsp_pipeline_process(float* left, float* right, uint32_t frames)
+{
+    if (next_chain != active_chain) {
+        dsp_pipeline_swap();
+    }
+    // Coefficient updates land on a block boundary, also for stages not in the
+    // chain so that the main loop never waits on them
+    for (uint8_t s = 0; s < stage_count; s++) {
+        if (stages[s].bank) {
+            dsp_bank_acquire(stages[s].bank);
+        }
+    }
+    const dsp_chain_t* ch = &chains[active_chain];
+
+    uint32_t pos = frame_pos;
+    while (frames > 0) {
+        uint32_t n = (frames > DSP_PIPELINE_MAX_FRAMES) ? DSP_PIPELINE_MAX_FRAMES : frames;
+        // Due events land on this chunk's first frame, the chunk ends before the next one
+        n = dsp_auto_run(pos, n, dsp_pipeline_apply_event);
+        for (uint8_t i = 0; i < ch->count; i++) {
+            dsp_stage_t* st = &stages[ch->slots[i].stage];
+            dsp_pipeline_run_stage(st, ch->slots[i].bypass || st->auto_bypass, left, right, n);
+        }
+        left += n;
+        right += n;
+        frames -= n;
+        pos += n;
+    }
+    frame_pos = pos;
+}
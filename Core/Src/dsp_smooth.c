@@ -0,0 +1,62 @@
+#include "dsp_smooth.h"
+#include <math.h>
+
+/**
+ * @brief Initialize an exponential smoother
+ * @param p Parameter
+ * @param fs Sample rate in Hz
+ * @param time_ms Time constant in ms (63 % of a step)
+ * @param value Initial value and target
+ */
+void dsp_smooth_init_one_pole(dsp_smooth_t* p, float fs, float time_ms, float value)
+{
+    p->coef = (time_ms > 0.0f) ? 1.0f - expf(-1000.0f / (time_ms * fs)) : 1.0f;
+    p->step = 0.0f;
+    p->ramp_len = 0;
+    p->remaining = 0;
+    p->value = value;
+    p->target = value;
+}
+
+/**
+ * @brief Initialize a linear ramp smoother
+ * @param p Parameter
+ * @param fs Sample rate in Hz
+ * @param time_ms Ramp duration in ms for any step size
+ * @param value Initial value and target
+ */
+void dsp_smooth_init_linear(dsp_smooth_t* p, float fs, float time_ms, float value)
+{
+    float len = time_ms * fs / 1000.0f;
+    p->coef = 0.0f;
+    p->step = 0.0f;
+    p->ramp_len = (len >= 1.0f) ? (uint32_t)len : 1U;
+    p->remaining = 0;
+    p->value = value;
+    p->target = value;
+}
+
+/**
+ * @brief Set a new target, a linear ramp restarts from the current value only when it changes
+ */
+void dsp_smooth_set_target(dsp_smooth_t* p, float target)
+{
+    if (target == p->target) {
+        return;
+    }
+    p->target = target;
+    if (p->coef == 0.0f) {
+        p->step = (target - p->value) / (float)p->ramp_len;
+        p->remaining = p->ramp_len;
+    }
+}
+
+/**
+ * @brief Jump to a value without gliding
+ */
+void dsp_smooth_snap(dsp_smooth_t* p, float value)
+{
+    p->value = value;
+    p->target = value;
+    p->remaining = 0;
+}
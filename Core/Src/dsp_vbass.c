@@ -0,0 +1,138 @@
+#include "dsp_vbass.h"
+#include <math.h>
+#include <string.h>
+
+/**
+ * @brief Design the split and harmonic filters for a cutoff frequency
+ */
+static void dsp_vbass_design(dsp_vbass_coef_t* c, float fs, float cutoff_hz)
+{
+    dsp_biquad_design_lpf(&c->split_lp, fs, cutoff_hz, DSP_BIQUAD_Q_BUTTERWORTH);
+    dsp_biquad_design_hpf(&c->harm_hp, fs, cutoff_hz, DSP_BIQUAD_Q_BUTTERWORTH);
+    dsp_biquad_design_lpf(&c->harm_lp, fs, cutoff_hz * DSP_VBASS_HARM_LP_RATIO, DSP_BIQUAD_Q_BUTTERWORTH);
+}
+
+/**
+ * @brief Initialize a virtual bass stage (disabled, 100 Hz cutoff)
+ * @param vb Stage instance
+ * @param fs Sample rate in Hz
+ */
+void dsp_vbass_init(dsp_vbass_t* vb, float fs)
+{
+    memset(vb, 0, sizeof(*vb));
+    vb->fs = fs;
+    dsp_smooth_init_one_pole(&vb->harm_gain, fs, DSP_VBASS_SMOOTH_MS, 0.0f);
+    dsp_smooth_init_one_pole(&vb->cut_gain, fs, DSP_VBASS_SMOOTH_MS, 0.0f);
+    dsp_smooth_init_one_pole(&vb->even_mix, fs, DSP_VBASS_SMOOTH_MS, 0.5f);
+    vb->coef[0].even_mix = 0.5f;
+    dsp_vbass_design(&vb->coef[0], fs, 100.0f);
+    vb->coef[1] = vb->coef[0];
+    dsp_bank_init(&vb->bank);
+}
+
+/**
+ * @brief Update the virtual bass parameters (main loop), gains glide to the new values
+ * @param vb Stage instance
+ * @param enable true to enable, false to fade the effect out
+ * @param cutoff_hz Split frequency (DSP_VBASS_CUTOFF_MIN_HZ..DSP_VBASS_CUTOFF_MAX_HZ)
+ * @param harm_db Harmonic level in dB (DSP_VBASS_HARM_MIN_DB..DSP_VBASS_HARM_MAX_DB)
+ * @param keep Fraction of the original low band kept (0..1)
+ * @param even_mix Share of even harmonics vs odd harmonics (0..1)
+ * @return false if the previous update has not been picked up by the audio path yet
+ */
+bool dsp_vbass_set(dsp_vbass_t* vb, bool enable, float cutoff_hz, float harm_db, float keep, float even_mix)
+{
+    if (dsp_bank_pending(&vb->bank)) {
+        return false;
+    }
+    if (cutoff_hz < DSP_VBASS_CUTOFF_MIN_HZ) cutoff_hz = DSP_VBASS_CUTOFF_MIN_HZ;
+    if (cutoff_hz > DSP_VBASS_CUTOFF_MAX_HZ) cutoff_hz = DSP_VBASS_CUTOFF_MAX_HZ;
+    if (harm_db < DSP_VBASS_HARM_MIN_DB) harm_db = DSP_VBASS_HARM_MIN_DB;
+    if (harm_db > DSP_VBASS_HARM_MAX_DB) harm_db = DSP_VBASS_HARM_MAX_DB;
+    if (keep < 0.0f) keep = 0.0f;
+    if (keep > 1.0f) keep = 1.0f;
+    if (even_mix < 0.0f) even_mix = 0.0f;
+    if (even_mix > 1.0f) even_mix = 1.0f;
+
+    dsp_vbass_coef_t* c = &vb->coef[dsp_bank_staging(&vb->bank)];
+    dsp_vbass_design(c, vb->fs, cutoff_hz);
+    c->enable = enable;
+    c->harm_gain = enable ? powf(10.0f, harm_db / 20.0f) : 0.0f;
+    c->cut_gain = enable ? (1.0f - keep) : 0.0f;
+    c->even_mix = even_mix;
+
+    dsp_bank_publish(&vb->bank);
+    return true;
+}
+
+/**
+ * @brief Override one parameter at a chunk boundary (audio path, automation)
+ * @return false for an unknown parameter
+ */
+bool dsp_vbass_set_param(dsp_vbass_t* vb, uint8_t param, float value)
+{
+    const dsp_vbass_coef_t* c = &vb->coef[vb->bank.active];
+    if (param != DSP_VBASS_PARAM_HARM_DB) {
+        return false;
+    }
+    if (value < DSP_VBASS_HARM_MIN_DB) value = DSP_VBASS_HARM_MIN_DB;
+    if (value > DSP_VBASS_HARM_MAX_DB) value = DSP_VBASS_HARM_MAX_DB;
+    if (c->enable) {
+        dsp_override_set(&vb->auto_harm, c->harm_gain, powf(10.0f, value / 20.0f));
+    }
+    return true;
+}
+
+/**
+ * @brief Process one block in place
+ * @param vb Stage instance
+ * @param left Left channel samples
+ * @param right Right channel samples
+ * @param frames Number of frames
+ */
+void dsp_vbass_process(dsp_vbass_t* vb, float* left, float* right, uint32_t frames)
+{
+    const dsp_vbass_coef_t* c = &vb->coef[vb->bank.active];
+
+    dsp_smooth_set_target(&vb->harm_gain, dsp_override_apply(&vb->auto_harm, c->harm_gain));
+    dsp_smooth_set_target(&vb->cut_gain, c->cut_gain);
+    dsp_smooth_set_target(&vb->even_mix, c->even_mix);
+
+    // Fully faded out: nothing to add or remove
+    if (!c->enable && dsp_smooth_settled(&vb->harm_gain) && dsp_smooth_settled(&vb->cut_gain)) {
+        return;
+    }
+
+    // Local copies keep the smoothers in registers across the loop
+    dsp_smooth_t harm_gain = vb->harm_gain;
+    dsp_smooth_t cut_gain = vb->cut_gain;
+    dsp_smooth_t even_mix = vb->even_mix;
+
+    for (uint32_t i = 0; i < frames; i++) {
+        float hg = dsp_smooth_next(&harm_gain);
+        float cg = dsp_smooth_next(&cut_gain);
+        float em = dsp_smooth_next(&even_mix);
+
+        // LR4 low band of the mono sum
+        float low = 0.5f * (left[i] + right[i]);
+        low = dsp_biquad_tick(&c->split_lp, &vb->split_st[0], low);
+        low = dsp_biquad_tick(&c->split_lp, &vb->split_st[1], low);
+
+        // Harmonic generation: rectifier for even, x/(1+|x|) soft clip for odd
+        float mag = fabsf(low);
+        float odd = 4.0f * low / (1.0f + 4.0f * mag);
+        float harm = em * mag + (1.0f - em) * 0.25f * odd;
+
+        // Band-limit to cutoff..4*cutoff, removes DC and most of the fundamental
+        harm = dsp_biquad_tick(&c->harm_hp, &vb->harm_hp_st, harm);
+        harm = dsp_biquad_tick(&c->harm_lp, &vb->harm_lp_st, harm);
+
+        float add = hg * harm - cg * low;
+        left[i]  += add;
+        right[i] += add;
+    }
+
+    vb->harm_gain = harm_gain;
+    vb->cut_gain = cut_gain;
+    vb->even_mix = even_mix;
+}
@@ -0,0 +1,169 @@
+#include "dsp_width.h"
+#include <math.h>
+#include <string.h>
+
+// Mid/side gains per width percent, shared by all instances
+static float mid_table[DSP_WIDTH_MAX_PCT + 1];
+static float side_table[DSP_WIDTH_MAX_PCT + 1];
+static bool tables_ready = false;
+
+/**
+ * @brief Fill the width -> (mid, side) gain tables
+ */
+static void dsp_width_build_tables(void)
+{
+    for (uint32_t pct = 0; pct <= DSP_WIDTH_MAX_PCT; pct++) {
+        float w = (float)pct / 100.0f;
+        // Narrowing only scales the side; widening trades mid for side so gm + gs <= 2
+        float gm = (w <= 1.0f) ? 1.0f : 2.0f / (1.0f + w);
+        mid_table[pct] = gm;
+        side_table[pct] = w * gm;
+    }
+    tables_ready = true;
+}
+
+/**
+ * @brief Initialize a width stage at 100 % (transparent)
+ * @param w Stage instance
+ * @param fs Sample rate in Hz
+ */
+void dsp_width_init(dsp_width_t* w, float fs)
+{
+    if (!tables_ready) {
+        dsp_width_build_tables();
+    }
+    memset(w, 0, sizeof(*w));
+    w->fs = fs;
+    dsp_smooth_init_one_pole(&w->mid_gain, fs, DSP_WIDTH_SMOOTH_MS, 1.0f);
+    dsp_smooth_init_one_pole(&w->side_gain, fs, DSP_WIDTH_SMOOTH_MS, 1.0f);
+    w->coef[0].mid_gain = 1.0f;
+    w->coef[0].side_gain = 1.0f;
+    dsp_biquad_design_hpf(&w->coef[0].hpf, fs, 120.0f, DSP_BIQUAD_Q_BUTTERWORTH);
+    w->coef[1] = w->coef[0];
+    dsp_bank_init(&w->bank);
+}
+
+/**
+ * @brief Set the stereo width (main loop), the gains glide to the new value
+ * @param w Stage instance
+ * @param width_pct Width in percent (0..DSP_WIDTH_MAX_PCT)
+ * @param side_hpf true to high-pass the side channel
+ * @param hpf_hz Side high-pass cutoff in Hz (DSP_WIDTH_HPF_MIN_HZ..DSP_WIDTH_HPF_MAX_HZ)
+ * @return false if the previous update has not been picked up by the audio path yet
+ */
+bool dsp_width_set(dsp_width_t* w, uint16_t width_pct, bool side_hpf, float hpf_hz)
+{
+    if (dsp_bank_pending(&w->bank)) {
+        return false;
+    }
+    if (width_pct > DSP_WIDTH_MAX_PCT) {
+        width_pct = DSP_WIDTH_MAX_PCT;
+    }
+    if (hpf_hz < DSP_WIDTH_HPF_MIN_HZ) hpf_hz = DSP_WIDTH_HPF_MIN_HZ;
+    if (hpf_hz > DSP_WIDTH_HPF_MAX_HZ) hpf_hz = DSP_WIDTH_HPF_MAX_HZ;
+
+    dsp_width_coef_t* c = &w->coef[dsp_bank_staging(&w->bank)];
+    if (side_hpf) {
+        dsp_biquad_design_hpf(&c->hpf, w->fs, hpf_hz, DSP_BIQUAD_Q_BUTTERWORTH);
+    }
+    c->hpf_enable = side_hpf;
+    c->mid_gain = mid_table[width_pct];
+    c->side_gain = side_table[width_pct];
+
+    dsp_bank_publish(&w->bank);
+    return true;
+}
+
+/**
+ * @brief Override one parameter at a chunk boundary (audio path, automation)
+ * @return false for an unknown parameter
+ */
+bool dsp_width_set_param(dsp_width_t* w, uint8_t param, float value)
+{
+    const dsp_width_coef_t* c = &w->coef[w->bank.active];
+    if (param != DSP_WIDTH_PARAM_PCT) {
+        return false;
+    }
+    if (value < 0.0f) value = 0.0f;
+    if (value > (float)DSP_WIDTH_MAX_PCT) value = (float)DSP_WIDTH_MAX_PCT;
+    uint32_t pct = (uint32_t)(value + 0.5f);
+    dsp_override_set(&w->auto_mid, c->mid_gain, mid_table[pct]);
+    dsp_override_set(&w->auto_side, c->side_gain, side_table[pct]);
+    return true;
+}
+
+/**
+ * @brief Process one block in place (fused M/S encode, filter, gain and decode)
+ * @param w Stage instance
+ * @param left Left channel samples
+ * @param right Right channel samples
+ * @param frames Number of frames
+ */
+void dsp_width_process(dsp_width_t* w, float* left, float* right, uint32_t frames)
+{
+    const dsp_width_coef_t* cf = &w->coef[w->bank.active];
+
+    if (cf->hpf_enable && !w->hpf_running) {
+        // Side filter switched on, start it from rest rather than stale state
+        dsp_biquad_reset(&w->hpf_st);
+    }
+    w->hpf_running = cf->hpf_enable;
+
+    // Mid and side gains come from one width: drop both overrides together
+    float mid_gain = dsp_override_apply(&w->auto_mid, cf->mid_gain);
+    float side_gain = dsp_override_apply(&w->auto_side, cf->side_gain);
+    if (w->auto_mid.on != w->auto_side.on) {
+        w->auto_mid.on = false;
+        w->auto_side.on = false;
+        mid_gain = cf->mid_gain;
+        side_gain = cf->side_gain;
+    }
+    dsp_smooth_set_target(&w->mid_gain, mid_gain);
+    dsp_smooth_set_target(&w->side_gain, side_gain);
+
+    // Settled at unity without side filtering: bit-transparent, skip the block
+    if (!cf->hpf_enable && mid_gain == 1.0f && side_gain == 1.0f
+            && dsp_smooth_settled(&w->mid_gain) && dsp_smooth_settled(&w->side_gain)) {
+        return;
+    }
+
+    dsp_smooth_t gm = w->mid_gain;
+    dsp_smooth_t gs = w->side_gain;
+
+    if (cf->hpf_enable) {
+        const dsp_biquad_coef_t* c = &cf->hpf;
+        float z1 = w->hpf_st.z1;
+        float z2 = w->hpf_st.z2;
+        for (uint32_t i = 0; i < frames; i++) {
+            float g_mid = dsp_smooth_next(&gm);
+            float g_side = dsp_smooth_next(&gs);
+            float l = left[i];
+            float r = right[i];
+            float m = 0.5f * (l + r);
+            float s = 0.5f * (l - r);
+            float y = c->b0 * s + z1;
+            z1 = c->b1 * s - c->a1 * y + z2;
+            z2 = c->b2 * s - c->a2 * y;
+            m *= g_mid;
+            y *= g_side;
+            left[i] = m + y;
+            right[i] = m - y;
+        }
+        w->hpf_st.z1 = z1;
+        w->hpf_st.z2 = z2;
+    } else {
+        for (uint32_t i = 0; i < frames; i++) {
+            float g_mid = dsp_smooth_next(&gm);
+            float g_side = dsp_smooth_next(&gs);
+            float l = left[i];
+            float r = right[i];
+            float m = g_mid * 0.5f * (l + r);
+            float s = g_side * 0.5f * (l - r);
+            left[i] = m + s;
+            right[i] = m - s;
+        }
+    }
+
+    w->mid_gain = gm;
+    w->side_gain = gs;
+}
@@ -24,6 +24,7 @@
 /* USER CODE BEGIN Includes */
 #include "sgtl5000.h"
 #include "cmd_ctrl.h"
+#include "audio_stream.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -63,7 +64,7 @@ static void MX_I2S2_Init(void);
 /* USER CODE BEGIN PFP */
 int _write(int file, char *ptr, int len)
 {
-    HAL_UART_Transmit(&huart2, (uint8_t *)ptr, len, HAL_MAX_DELAY);
+    ctrl_tx_write(ptr, (uint32_t)len); // Interrupt-driven, waits only while the ring is full
     return len;
 }
 /* USER CODE END PFP */
@@ -109,6 +110,7 @@ int main(void)
   MX_I2S2_Init();
   /* USER CODE BEGIN 2 */
   ctrl_init();
+  audio_stream_init();
   uint8_t status;
   status = sgtl5000_init();
   if (status != I2C_SUCCESS) {
@@ -135,6 +137,8 @@ int main(void)
     // Blink LED or do other tasks...
     HAL_GPIO_TogglePin(GPIOE, GPIO_PIN_3);
     ctrl_poll();
+    sgtl5000_i2c_poll();
+    sgtl5000_health_task();
   }
   /* USER CODE END 3 */
 }
@@ -204,7 +208,7 @@ static void MX_I2C1_Init(void)
 
   /* USER CODE END I2C1_Init 1 */
   hi2c1.Instance = I2C1;
-  hi2c1.Init.ClockSpeed = 100000;
+  hi2c1.Init.ClockSpeed = 400000;
   hi2c1.Init.DutyCycle = I2C_DUTYCYCLE_2;
   hi2c1.Init.OwnAddress1 = 0;
   hi2c1.Init.AddressingMode = I2C_ADDRESSINGMODE_7BIT;
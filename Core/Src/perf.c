@@ -0,0 +1,118 @@
+#include "perf.h"
+#include <stdio.h>
+#include <string.h>
+
+static perf_counter_t counters[PERF_MAX_COUNTERS];
+static uint8_t counter_count = 0;
+static uint32_t budget = 1;   // Cycles available per audio block
+
+static const char* const fixed_names[PERF_ID_FIXED_COUNT] = {
+    "i2s_irq",
+    "usb_irq",
+    "chain",
+    "spectrum",
+};
+
+static void perf_clear(perf_counter_t* c)
+{
+    c->calls = 0;
+    c->min = UINT32_MAX;
+    c->max = 0;
+    c->total = 0;
+    c->reset = false;
+}
+
+/**
+ * @brief Enable the DWT cycle counter and register the fixed counters
+ * @param budget_cycles CPU cycles per audio block (real-time budget), in PERF_CLOCK_HZ ticks
+ */
+void perf_init(uint32_t budget_cycles)
+{
+#ifndef DSP_HOST
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+
+    budget = (budget_cycles > 0) ? budget_cycles : 1;
+    memset(counters, 0, sizeof(counters));
+    for (uint8_t i = 0; i < PERF_ID_FIXED_COUNT; i++) {
+        counters[i].name = fixed_names[i];
+        perf_clear(&counters[i]);
+    }
+    counter_count = PERF_ID_FIXED_COUNT;
+}
+
+/**
+ * @brief Register an additional counter
+ * @param name Name shown by the perf command
+ * @return Counter id, or -1 if all counters are in use
+ */
+int8_t perf_register(const char* name)
+{
+    if (counter_count >= PERF_MAX_COUNTERS) {
+        return -1;
+    }
+    counters[counter_count].name = name;
+    perf_clear(&counters[counter_count]);
+    return (int8_t)counter_count++;
+}
+
+/**
+ * @brief Add one measurement to a counter
+ * @param id Counter id, negative ids are ignored
+ * @param cycles Measured cycles
+ */
+void perf_record(int8_t id, uint32_t cycles)
+{
+    if (id < 0 || (uint8_t)id >= counter_count) {
+        return;
+    }
+    perf_counter_t* c = &counters[id];
+    if (c->reset) {
+        perf_clear(c);
+    }
+    c->calls++;
+    c->total += cycles;
+    if (cycles < c->min) {
+        c->min = cycles;
+    }
+    if (cycles > c->max) {
+        c->max = cycles;
+    }
+}
+
+/**
+ * @brief Request a reset of every counter
+ */
+void perf_reset(void)
+{
+    for (uint8_t i = 0; i < counter_count; i++) {
+        counters[i].reset = true;
+    }
+}
+
+/**
+ * @brief Print min/avg/max cycles per call and their share of the block budget
+ */
+void perf_report(void)
+{
+    printf("Budget: %lu cycles/block @ %lu Hz core (halves at 96 kHz)\r\n",
+           (unsigned long)budget, (unsigned long)PERF_CLOCK_HZ);
+    printf("%-10s %8s %8s %8s %8s %7s %7s\r\n", "name", "calls", "min", "avg", "max", "avg%", "max%");
+
+    for (uint8_t i = 0; i < counter_count; i++) {
+        perf_counter_t snap = counters[i];
+        if (snap.reset || snap.calls == 0) {
+            printf("%-10s %8u %8s %8s %8s %7s %7s\r\n", snap.name, 0U, "-", "-", "-", "-", "-");
+            continue;
+        }
+        uint32_t avg = (uint32_t)(snap.total / snap.calls);
+        uint32_t avg_pct10 = (uint32_t)(((uint64_t)avg * 1000U) / budget);
+        uint32_t max_pct10 = (uint32_t)(((uint64_t)snap.max * 1000U) / budget);
+        printf("%-10s %8lu %8lu %8lu %8lu %5lu.%lu %5lu.%lu\r\n", snap.name,
+               (unsigned long)snap.calls, (unsigned long)snap.min, (unsigned long)avg, (unsigned long)snap.max,
+               (unsigned long)(avg_pct10 / 10U), (unsigned long)(avg_pct10 % 10U),
+               (unsigned long)(max_pct10 / 10U), (unsigned long)(max_pct10 % 10U));
+    }
+}
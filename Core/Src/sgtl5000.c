@@ -1,53 +1,832 @@
 #include "sgtl5000.h"
+#include "perf.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <math.h>
 
 extern I2C_HandleTypeDef hi2c1;
 
+// RAM shadow of the codec registers
+//
+// Every write lands here when it is queued, so read-modify-write sequences
+// only cost the write and later modifies build on the queued state. Entries
+// become valid when the register is read or written; the whole shadow is
+// dropped after a failed transfer, since the chip state is then unknown.
+static uint16_t reg_shadow[SGTL5000_REG_COUNT];
+static uint32_t reg_valid[(SGTL5000_REG_COUNT + 31U) / 32U];
+static bool verify_writes = SGTL5000_VERIFY_WRITES;
+
+// Registers the driver configures, read once by sgtl5000_cache_fill()
+static const uint16_t cache_fill_regs[] = {
+    SGTL5000_CHIP_DIG_POWER, SGTL5000_CHIP_CLK_CTRL, SGTL5000_CHIP_I2S_CTRL, SGTL5000_CHIP_SSS_CTRL,
+    SGTL5000_CHIP_ADCDAC_CTRL, SGTL5000_CHIP_DAC_VOL, SGTL5000_CHIP_PAD_STRENGTH, SGTL5000_CHIP_ANA_ADC_CTRL,
+    SGTL5000_CHIP_ANA_HP_CTRL, SGTL5000_CHIP_ANA_CTRL, SGTL5000_CHIP_LINREG_CTRL, SGTL5000_CHIP_REF_CTRL,
+    SGTL5000_CHIP_MIC_CTRL, SGTL5000_CHIP_LINE_OUT_CTRL, SGTL5000_CHIP_LINE_OUT_VOL, SGTL5000_CHIP_ANA_POWER,
+    SGTL5000_CHIP_PLL_CTRL, SGTL5000_CHIP_CLK_TOP_CTRL, SGTL5000_CHIP_SHORT_CTRL, SGTL5000_CHIP_ANA_TEST2,
+    SGTL5000_DAP_CTRL, SGTL5000_DAP_PEQ, SGTL5000_DAP_BASS_ENHANCE, SGTL5000_DAP_BASS_ENHANCE_CTRL,
+    SGTL5000_DAP_AUDIO_EQ, SGTL5000_DAP_SURROUND, SGTL5000_DAP_EQ_BAND0, SGTL5000_DAP_EQ_BAND1,
+    SGTL5000_DAP_EQ_BAND2, SGTL5000_DAP_EQ_BAND3, SGTL5000_DAP_EQ_BAND4, SGTL5000_DAP_MAIN_CHAN,
+    SGTL5000_DAP_MIX_CHAN, SGTL5000_DAP_AVC_CTRL, SGTL5000_DAP_AVC_THRESHOLD, SGTL5000_DAP_AVC_ATTACK,
+    SGTL5000_DAP_AVC_DECAY,
+};
+
 /**
- * @brief Read a register of SGTL5000 audio codec
- * 
+ * @brief true if a register may be served from the shadow
+ *
+ * The ID and status registers are read-only and change (or identify the
+ * chip) behind the driver's back; FLT_COEF_ACCESS has self-clearing bits.
+ */
+static bool sgtl5000_reg_cacheable(uint16_t reg)
+{
+    if (reg > SGTL5000_REG_LAST || (reg & 1U)) {
+        return false;
+    }
+    switch (reg) {
+    case SGTL5000_CHIP_ID:
+    case SGTL5000_CHIP_ANA_STATUS:
+    case SGTL5000_DAP_FLT_COEF_ACCESS:
+        return false;
+    default:
+        return true;
+    }
+}
+
+static void sgtl5000_cache_store(uint16_t reg, uint16_t val)
+{
+    if (sgtl5000_reg_cacheable(reg)) {
+        uint16_t idx = reg >> 1;
+        reg_shadow[idx] = val;
+        reg_valid[idx >> 5] |= 1UL << (idx & 31U);
+    }
+}
+
+static bool sgtl5000_cache_lookup(uint16_t reg, uint16_t* val)
+{
+    if (!sgtl5000_reg_cacheable(reg)) {
+        return false;
+    }
+    uint16_t idx = reg >> 1;
+    if (!(reg_valid[idx >> 5] & (1UL << (idx & 31U)))) {
+        return false;
+    }
+    *val = reg_shadow[idx];
+    return true;
+}
+
+// Asynchronous I2C transaction queue
+//
+// The register API only enqueues. Transfers run on the I2C1 event/error
+// interrupts and each completion starts the next one, so the main loop and
+// the shell keep running while the codec is reprogrammed. Delay entries hold
+// the queue for a number of ms and are resumed by sgtl5000_i2c_poll(), which
+// also fails transfers that hang. The main loop and the ramp engine on
+// SysTick enqueue, both under sgtl5000_i2c_lock().
+typedef enum {
+    I2C_OP_WRITE,
+    I2C_OP_READ,
+    I2C_OP_DELAY
+} i2c_op_t;
+
+typedef struct {
+    uint16_t reg;               // (First) register address, or delay in ms
+    uint8_t  op;                // i2c_op_t
+    uint8_t  len;               // Bytes in buf
+    uint8_t  buf[2U * SGTL5000_I2C_BURST_MAX]; // Register values, MSB first
+    sgtl5000_future_t* done;    // Optional completion future
+} i2c_xfer_t;
+
+static i2c_xfer_t i2c_queue[SGTL5000_I2C_QUEUE_LEN];
+static volatile uint16_t i2c_head;      // Next free entry, main loop only
+static volatile uint16_t i2c_tail;      // Entry on the bus, advanced on completion
+static volatile bool     i2c_active;    // Transfer or delay running for i2c_queue[i2c_tail]
+static volatile uint32_t i2c_started;   // HAL tick the running entry started at
+static volatile uint32_t i2c_errors;    // Failed transfers since boot
+static volatile uint16_t i2c_error_reg; // Register of the last failed transfer
+static uint32_t i2c_errors_seen;        // i2c_errors already reported by the poll
+static uint32_t i2c_errors_flushed;     // i2c_errors at the last sgtl5000_i2c_flush()
+
+// Keep the I2C interrupts and SysTick out while the queue or the shadow is
+// touched; BASEPRI leaves the I2S DMA and USART interrupts running
+static uint32_t sgtl5000_i2c_lock(void)
+{
+    uint32_t key = __get_BASEPRI();
+    __set_BASEPRI_MAX(SGTL5000_I2C_IRQ_PRIO << (8U - __NVIC_PRIO_BITS));
+    return key;
+}
+
+static void sgtl5000_i2c_unlock(uint32_t key)
+{
+    __set_BASEPRI(key);
+}
+
+/**
+ * @brief Retire the running entry and complete its future
+ */
+static void sgtl5000_i2c_finish(uint8_t status)
+{
+    i2c_xfer_t* x = &i2c_queue[i2c_tail];
+    if (status != I2C_SUCCESS) {
+        i2c_error_reg = x->reg;
+        i2c_errors++;
+    }
+    if (x->done != NULL) {
+        x->done->value = ((uint16_t)x->buf[0] << 8) | x->buf[1]; // SGTL5000 sends MSB first
+        x->done->status = status;
+    }
+    i2c_tail = (uint16_t)((i2c_tail + 1U) & (SGTL5000_I2C_QUEUE_LEN - 1U));
+    i2c_active = false;
+}
+
+/**
+ * @brief Wait briefly for the bus to go idle
+ *
+ * The STOP of the previous transfer clears BUSY within a few bus clocks. A
+ * stuck bus keeps it set, and the HAL would spin on it for 25 ms per entry
+ * with SysTick masked, so give up after SGTL5000_I2C_BUSY_US.
+ */
+static bool sgtl5000_i2c_bus_idle(void)
+{
+    uint32_t start = perf_cycles();
+    uint32_t cycles = SGTL5000_I2C_BUSY_US * (SystemCoreClock / 1000000U);
+    while (__HAL_I2C_GET_FLAG(&hi2c1, I2C_FLAG_BUSY)) {
+        if ((perf_cycles() - start) >= cycles) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Start the next queued entry, from the completion interrupts or under sgtl5000_i2c_lock()
+ */
+static void sgtl5000_i2c_start(void)
+{
+    while (!i2c_active && i2c_tail != i2c_head) {
+        i2c_xfer_t* x = &i2c_queue[i2c_tail];
+        i2c_started = HAL_GetTick();
+        i2c_active = true;
+        if (x->op == I2C_OP_DELAY) {
+            return; // Resumed by sgtl5000_i2c_poll()
+        }
+        if (!sgtl5000_i2c_bus_idle()) {
+            return; // Left running, sgtl5000_i2c_poll() times it out and resets the peripheral
+        }
+        HAL_StatusTypeDef hal;
+        if (x->op == I2C_OP_WRITE) {
+            hal = HAL_I2C_Mem_Write_IT(&hi2c1, SGTL5000_ADDR, x->reg, I2C_MEMADD_SIZE_16BIT, x->buf, x->len);
+        }
+        else {
+            hal = HAL_I2C_Mem_Read_IT(&hi2c1, SGTL5000_ADDR, x->reg, I2C_MEMADD_SIZE_16BIT, x->buf, x->len);
+        }
+        if (hal != HAL_OK) {
+            sgtl5000_i2c_finish(I2C_FAIL); // Bus busy or peripheral in error, try the next one
+        }
+    }
+}
+
+/**
+ * @brief Append an entry under sgtl5000_i2c_lock(), written registers go to the shadow
+ *
+ * @param count Registers to write from vals (writes), 1 for reads, 0 for delays
+ * @return false if the queue is full
+ */
+static bool sgtl5000_i2c_enqueue(uint8_t op, uint16_t reg, const uint16_t* vals, uint8_t count, sgtl5000_future_t* done)
+{
+    uint16_t next = (uint16_t)((i2c_head + 1U) & (SGTL5000_I2C_QUEUE_LEN - 1U));
+    if (next == i2c_tail) {
+        return false;
+    }
+
+    i2c_xfer_t* x = &i2c_queue[i2c_head];
+    x->reg = reg;
+    x->op = op;
+    x->len = (uint8_t)(2U * count);
+    x->done = done;
+    for (uint8_t i = 0; vals != NULL && i < count; i++) {
+        x->buf[2U * i]      = (uint8_t)(vals[i] >> 8); // Prepare data in MSB first format
+        x->buf[2U * i + 1U] = (uint8_t)(vals[i] & 0xFF);
+        if (op == I2C_OP_WRITE) {
+            sgtl5000_cache_store((uint16_t)(reg + 2U * i), vals[i]);
+        }
+    }
+    if (done != NULL) {
+        done->status = I2C_PENDING;
+    }
+
+    i2c_head = next;
+    sgtl5000_i2c_start();
+    return true;
+}
+
+/**
+ * @brief Append an entry from the main loop, waiting for a free slot if the queue is full
+ */
+static uint8_t sgtl5000_i2c_push(uint8_t op, uint16_t reg, const uint16_t* vals, uint8_t count, sgtl5000_future_t* done)
+{
+    for (;;) {
+        uint32_t key = sgtl5000_i2c_lock();
+        bool queued = sgtl5000_i2c_enqueue(op, reg, vals, count, done);
+        sgtl5000_i2c_unlock(key);
+        if (queued) {
+            return I2C_SUCCESS;
+        }
+        sgtl5000_i2c_poll();
+    }
+}
+
+/**
+ * @brief Queue a register write, the shadow takes the new value immediately
+ *
+ * @param reg 16-bit register address
+ * @param val 16-bit value to write
+ * @param done Optional future completed when the write is on the chip (NULL for none)
+ * @return I2C_SUCCESS once queued
+ */
+uint8_t sgtl5000_reg_write_async(uint16_t reg, uint16_t val, sgtl5000_future_t* done)
+{
+    return sgtl5000_i2c_push(I2C_OP_WRITE, reg, &val, 1, done);
+}
+
+/**
+ * @brief Queue a write of consecutive registers as one I2C transaction
+ *
+ * The SGTL5000 auto-increments the register address by 2 after every
+ * 16-bit word, so one address phase covers the whole run.
+ * @param reg First 16-bit register address
+ * @param vals Values for reg, reg + 2, ... (copied, may be reused on return)
+ * @param count Number of registers, 1..SGTL5000_I2C_BURST_MAX
+ * @param done Optional future completed when the burst is on the chip (NULL for none)
+ * @return I2C_SUCCESS once queued, I2C_FAIL for an invalid run
+ */
+uint8_t sgtl5000_reg_write_burst_async(uint16_t reg, const uint16_t* vals, uint8_t count, sgtl5000_future_t* done)
+{
+    if (count == 0 || count > SGTL5000_I2C_BURST_MAX || (reg & 1U) ||
+        reg + 2U * (count - 1U) > SGTL5000_REG_LAST) {
+        return I2C_FAIL;
+    }
+    return sgtl5000_i2c_push(I2C_OP_WRITE, reg, vals, count, done);
+}
+
+/**
+ * @brief Queue a register read, the value arrives in the future
+ *
+ * @param reg 16-bit register address
+ * @param done Future receiving the value
+ * @return I2C_SUCCESS once queued
+ */
+uint8_t sgtl5000_reg_read_async(uint16_t reg, sgtl5000_future_t* done)
+{
+    return sgtl5000_i2c_push(I2C_OP_READ, reg, NULL, 1, done);
+}
+
+/**
+ * @brief Queue a pause between the transfers before and after it (ramps, power-up settling)
+ *
+ * @param ms Delay in milliseconds
+ * @return I2C_SUCCESS once queued
+ */
+uint8_t sgtl5000_queue_delay(uint16_t ms)
+{
+    return sgtl5000_i2c_push(I2C_OP_DELAY, ms, NULL, 0, NULL);
+}
+
+/**
+ * @brief Block until a future completes, keeping the queue moving
+ *
+ * @param done Future passed to one of the _async calls
+ * @return I2C_SUCCESS on success, I2C_FAIL on failure
+ */
+uint8_t sgtl5000_wait(sgtl5000_future_t* done)
+{
+    while (done->status == I2C_PENDING) {
+        sgtl5000_i2c_poll();
+    }
+    return done->status;
+}
+
+/**
+ * @brief Block until the queue is empty
+ *
+ * @return I2C_FAIL if any transfer failed since the previous flush, I2C_SUCCESS otherwise
+ */
+uint8_t sgtl5000_i2c_flush(void)
+{
+    while (i2c_active || i2c_tail != i2c_head) {
+        sgtl5000_i2c_poll();
+    }
+    uint32_t errors = i2c_errors;
+    uint8_t status = (errors != i2c_errors_flushed) ? I2C_FAIL : I2C_SUCCESS;
+    i2c_errors_flushed = errors;
+    return status;
+}
+
+/**
+ * @brief Number of queued entries, including the running one
+ */
+uint16_t sgtl5000_i2c_pending(void)
+{
+    return (uint16_t)((i2c_head - i2c_tail) & (SGTL5000_I2C_QUEUE_LEN - 1U));
+}
+
+/**
+ * @brief Failed transfers since boot
+ */
+uint32_t sgtl5000_i2c_errors(void)
+{
+    return i2c_errors;
+}
+
+/**
+ * @brief Main-loop service of the queue: ends delays, fails hung transfers, reports errors
+ */
+void sgtl5000_i2c_poll(void)
+{
+    uint32_t key = sgtl5000_i2c_lock();
+    if (i2c_active) {
+        i2c_xfer_t* x = &i2c_queue[i2c_tail];
+        uint32_t elapsed = HAL_GetTick() - i2c_started;
+        if (x->op == I2C_OP_DELAY) {
+            if (elapsed >= x->reg) {
+                sgtl5000_i2c_finish(I2C_SUCCESS);
+                sgtl5000_i2c_start();
+            }
+        }
+        else if (elapsed > SGTL5000_I2C_TIMEOUT_MS) {
+            // Abandon the transfer and restart the peripheral before the next
+            // one, under the lock so SysTick cannot start on a half-reset handle
+            sgtl5000_i2c_finish(I2C_FAIL);
+            HAL_I2C_DeInit(&hi2c1);
+            HAL_I2C_Init(&hi2c1);
+            sgtl5000_i2c_start();
+        }
+    }
+    sgtl5000_i2c_unlock(key);
+
+    uint32_t errors = i2c_errors;
+    if (errors != i2c_errors_seen) {
+        i2c_errors_seen = errors;
+        sgtl5000_cache_invalidate(); // Chip state unknown, read it again on the next modify
+        printf("Codec I2C transfer to 0x%04X failed (%lu errors)\r\n", i2c_error_reg, (unsigned long)errors);
+    }
+}
+
+void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef* hi2c)
+{
+    if (hi2c == &hi2c1) {
+        sgtl5000_i2c_finish(I2C_SUCCESS);
+        sgtl5000_i2c_start();
+    }
+}
+
+void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef* hi2c)
+{
+    if (hi2c == &hi2c1) {
+        sgtl5000_i2c_finish(I2C_SUCCESS);
+        sgtl5000_i2c_start();
+    }
+}
+
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef* hi2c)
+{
+    if (hi2c == &hi2c1 && i2c_active) {
+        sgtl5000_i2c_finish(I2C_FAIL);
+        sgtl5000_i2c_start();
+    }
+}
+
+// Ramp engine
+//
+// The GEQ bands and the bass-enhance level never jump: the setters only move
+// the goals, and sgtl5000_ramp_tick() on SysTick moves every ramp one code
+// towards its goal per tick, all of them together. Each tick posts one burst
+// of DAP_EQ_BAND0..4 (single writes of the moved bands in tone-control mode,
+// which only reads BAND0 and BAND4) and/or one BASS_ENHANCE_CTRL write into
+// the I2C queue, so a change takes at most SGTL5000_RAMP_MAX_STEPS ms however
+// many bands move.
+//
+// EQ mode changes (GEQ, tone control, PEQ, bypass) go through the same
+// engine instead of a DAC mute: the bands glide to flat, the mode is switched
+// with the bands at 0 dB, then they glide to the goals of the new mode.
+#define RAMP_BAND_FLAT  0x2F            // GEQ / tone band code for 0 dB
+
+static uint8_t  ramp_geq_now[5];
+static uint8_t  ramp_geq_goal[5];
+static uint8_t  ramp_geq_after[5];          // Band goals once the pending mode switch is done
+static volatile int8_t ramp_mode_next = -1; // DAP_AUDIO_EQ mode to switch to at flat, -1 for none
+static uint8_t  ramp_bass_now;
+static uint8_t  ramp_bass_goal;
+static uint16_t ramp_bass_ctrl;             // BASS_ENHANCE_CTRL bits above the level, if the shadow is gone
+static volatile bool     ramp_running;
+static volatile uint16_t ramp_steps;        // Ticks that posted a step in the current/last ramp
+static volatile uint32_t ramp_started;      // HAL tick the current/last ramp started at
+static volatile uint32_t ramp_ms;           // Duration of the last finished ramp
+
+// Move a ramp one code towards its goal
+static bool sgtl5000_ramp_step(uint8_t* now, uint8_t goal)
+{
+    if (*now < goal) {
+        (*now)++;
+        return true;
+    }
+    if (*now > goal) {
+        (*now)--;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Make sure the ramped registers are in the shadow (reads the chip after an I2C error)
+ */
+static uint8_t sgtl5000_ramp_prepare(void)
+{
+    uint16_t val;
+    for (uint8_t i = 0; i < 5; i++) {
+        if (sgtl5000_reg_get((uint16_t)(SGTL5000_DAP_EQ_BAND0 + 2U * i), &val) != I2C_SUCCESS) {
+            return I2C_FAIL;
+        }
+    }
+    if (sgtl5000_reg_get(SGTL5000_DAP_AUDIO_EQ, &val) != I2C_SUCCESS) {
+        return I2C_FAIL;
+    }
+    return sgtl5000_reg_get(SGTL5000_DAP_BASS_ENHANCE_CTRL, &val);
+}
+
+/**
+ * @brief Start a ramp from the shadow values, under sgtl5000_i2c_lock()
+ *
+ * A running ramp keeps its positions, the caller only moves the goals.
+ */
+static void sgtl5000_ramp_begin(void)
+{
+    if (ramp_running) {
+        return;
+    }
+    uint16_t val = 0;
+    for (uint8_t i = 0; i < 5; i++) {
+        sgtl5000_cache_lookup((uint16_t)(SGTL5000_DAP_EQ_BAND0 + 2U * i), &val);
+        ramp_geq_now[i] = ramp_geq_goal[i] = (uint8_t)(val & 0x007F);
+    }
+    val = 0;
+    sgtl5000_cache_lookup(SGTL5000_DAP_BASS_ENHANCE_CTRL, &val);
+    ramp_bass_ctrl = val & ~0x007F;
+    ramp_bass_now = ramp_bass_goal = (uint8_t)(val & 0x007F);
+    ramp_steps = 0;
+    ramp_started = HAL_GetTick();
+    ramp_running = true;
+}
+
+// true if the EQ mode uses the DAP_EQ_BANDx registers
+static bool sgtl5000_eq_mode_has_bands(uint8_t mode)
+{
+    return mode == DAP_AUDIO_EQ_GEQ || mode == DAP_AUDIO_EQ_TONE;
+}
+
+/**
+ * @brief Current EQ mode, or the one a running ramp is switching to
+ */
+uint8_t sgtl5000_dap_eq_mode_get(void)
+{
+    if (ramp_mode_next >= 0) {
+        return (uint8_t)ramp_mode_next;
+    }
+    uint16_t eq = 0;
+    sgtl5000_cache_lookup(SGTL5000_DAP_AUDIO_EQ, &eq);
+    return (uint8_t)(eq & DAP_AUDIO_EQ_EN_MASK);
+}
+
+/**
+ * @brief Ramp the bands selected by mask to goal in the given EQ mode, under sgtl5000_i2c_lock()
+ *
+ * Outside that mode the switch is queued on the ramp engine: bands to flat,
+ * mode write, then the new goals (unselected bands stay flat).
+ */
+static void sgtl5000_ramp_eq(uint8_t mode, const uint8_t goal[5], uint8_t mask)
+{
+    uint16_t eq = 0;
+    sgtl5000_cache_lookup(SGTL5000_DAP_AUDIO_EQ, &eq);
+    uint8_t cur = (uint8_t)(eq & DAP_AUDIO_EQ_EN_MASK);
+
+    sgtl5000_ramp_begin();
+    if (ramp_mode_next < 0 && cur == mode) {
+        for (uint8_t i = 0; i < 5; i++) {
+            if (mask & (1U << i)) {
+                ramp_geq_goal[i] = goal[i];
+            }
+        }
+        return;
+    }
+
+    if (ramp_mode_next != (int8_t)mode) {
+        for (uint8_t i = 0; i < 5; i++) {
+            ramp_geq_after[i] = RAMP_BAND_FLAT;
+        }
+    }
+    for (uint8_t i = 0; i < 5; i++) {
+        if (mask & (1U << i)) {
+            ramp_geq_after[i] = goal[i];
+        }
+        ramp_geq_goal[i] = RAMP_BAND_FLAT;
+        if (ramp_mode_next < 0 && !sgtl5000_eq_mode_has_bands(cur)) {
+            ramp_geq_now[i] = RAMP_BAND_FLAT; // Inaudible in this mode, rewritten at the switch
+        }
+    }
+    ramp_mode_next = (int8_t)mode;
+}
+
+/**
+ * @brief EQ mode and band codes the ramp engine is heading for, under sgtl5000_i2c_lock()
+ * @param band Output DAP_EQ_BAND0..4 codes
+ * @return DAP_AUDIO_EQ mode
+ */
+static uint8_t sgtl5000_ramp_eq_target(uint8_t band[5])
+{
+    if (ramp_mode_next >= 0) {
+        for (uint8_t i = 0; i < 5; i++) {
+            band[i] = ramp_geq_after[i];
+        }
+        return (uint8_t)ramp_mode_next;
+    }
+    uint16_t val = 0;
+    for (uint8_t i = 0; i < 5; i++) {
+        if (ramp_running) {
+            band[i] = ramp_geq_goal[i];
+        }
+        else {
+            sgtl5000_cache_lookup((uint16_t)(SGTL5000_DAP_EQ_BAND0 + 2U * i), &val);
+            band[i] = (uint8_t)(val & 0x007F);
+        }
+    }
+    val = 0;
+    sgtl5000_cache_lookup(SGTL5000_DAP_AUDIO_EQ, &val);
+    return (uint8_t)(val & DAP_AUDIO_EQ_EN_MASK);
+}
+
+/**
+ * @brief Advance every running ramp by one step, called from SysTick
+ *
+ * A tick is skipped while the queue is backed up (init, a dump), so ramp
+ * steps never pile up behind other traffic.
+ */
+void sgtl5000_ramp_tick(void)
+{
+    if (!ramp_running) {
+        return;
+    }
+    uint32_t key = sgtl5000_i2c_lock();
+    if (sgtl5000_i2c_pending() <= SGTL5000_RAMP_QUEUE_SLACK) {
+        uint8_t moved = 0; // Bit per band that stepped
+        for (uint8_t i = 0; i < 5; i++) {
+            if (sgtl5000_ramp_step(&ramp_geq_now[i], ramp_geq_goal[i])) {
+                moved |= (uint8_t)(1U << i);
+            }
+        }
+        bool geq = (moved != 0U);
+        bool bass = sgtl5000_ramp_step(&ramp_bass_now, ramp_bass_goal);
+
+        if (geq) {
+            uint16_t eq = 0;
+            bool tone = sgtl5000_cache_lookup(SGTL5000_DAP_AUDIO_EQ, &eq)
+                        && (eq & DAP_AUDIO_EQ_EN_MASK) == DAP_AUDIO_EQ_TONE;
+            if (tone) {
+                // Bass and treble shelves only: one short write per moved band
+                for (uint8_t i = 0; i < 5; i++) {
+                    if (moved & (1U << i)) {
+                        uint16_t val = ramp_geq_now[i];
+                        sgtl5000_i2c_enqueue(I2C_OP_WRITE, (uint16_t)(SGTL5000_DAP_EQ_BAND0 + 2U * i), &val, 1, NULL);
+                    }
+                }
+            }
+            else {
+                uint16_t band[5];
+                for (uint8_t i = 0; i < 5; i++) {
+                    band[i] = ramp_geq_now[i];
+                }
+                sgtl5000_i2c_enqueue(I2C_OP_WRITE, SGTL5000_DAP_EQ_BAND0, band, 5, NULL);
+            }
+        }
+        if (bass) {
+            uint16_t ctrl;
+            if (sgtl5000_cache_lookup(SGTL5000_DAP_BASS_ENHANCE_CTRL, &ctrl)) {
+                ramp_bass_ctrl = ctrl & ~0x007F; // Follows LR level changes made meanwhile
+            }
+            ctrl = ramp_bass_ctrl | ramp_bass_now;
+            sgtl5000_i2c_enqueue(I2C_OP_WRITE, SGTL5000_DAP_BASS_ENHANCE_CTRL, &ctrl, 1, NULL);
+        }
+
+        if (!geq && !bass && ramp_mode_next >= 0) {
+            // Bands are flat: load them, switch the mode, glide to the new goals
+            uint16_t band[5];
+            for (uint8_t i = 0; i < 5; i++) {
+                band[i] = ramp_geq_now[i];
+                ramp_geq_goal[i] = ramp_geq_after[i];
+            }
+            uint16_t eq = (uint16_t)ramp_mode_next;
+            sgtl5000_i2c_enqueue(I2C_OP_WRITE, SGTL5000_DAP_EQ_BAND0, band, 5, NULL);
+            sgtl5000_i2c_enqueue(I2C_OP_WRITE, SGTL5000_DAP_AUDIO_EQ, &eq, 1, NULL);
+            ramp_mode_next = -1;
+            geq = true;
+        }
+
+        if (geq || bass) {
+            ramp_steps++;
+        }
+        else {
+            ramp_ms = HAL_GetTick() - ramp_started;
+            ramp_running = false;
+        }
+    }
+    sgtl5000_i2c_unlock(key);
+}
+
+/**
+ * @brief true while any ramp still has steps to post
+ */
+bool sgtl5000_ramp_active(void)
+{
+    return ramp_running;
+}
+
+/**
+ * @brief Steps (= SysTicks) the running ramps still need, the longest of them
+ */
+uint16_t sgtl5000_ramp_remaining(void)
+{
+    uint16_t left = 0;
+    uint32_t key = sgtl5000_i2c_lock();
+    if (ramp_running) {
+        for (uint8_t i = 0; i < 5; i++) {
+            uint16_t d = (uint16_t)abs((int)ramp_geq_goal[i] - (int)ramp_geq_now[i]);
+            left = (d > left) ? d : left;
+        }
+        uint16_t d = (uint16_t)abs((int)ramp_bass_goal - (int)ramp_bass_now);
+        left = (d > left) ? d : left;
+        if (ramp_mode_next >= 0) {
+            uint16_t after = 0;
+            for (uint8_t i = 0; i < 5; i++) {
+                d = (uint16_t)abs((int)ramp_geq_after[i] - RAMP_BAND_FLAT);
+                after = (d > after) ? d : after;
+            }
+            left = (uint16_t)(left + 1U + after); // Glide to flat, switch, glide to the new goals
+        }
+    }
+    sgtl5000_i2c_unlock(key);
+    return left;
+}
+
+/**
+ * @brief Steps posted by the last finished (or the running) ramp
+ */
+uint16_t sgtl5000_ramp_last_steps(void)
+{
+    return ramp_steps;
+}
+
+/**
+ * @brief Duration of the last finished ramp in ms, first tick to last step on the queue
+ */
+uint32_t sgtl5000_ramp_last_ms(void)
+{
+    return ramp_ms;
+}
+
+/**
+ * @brief Read a register of SGTL5000 audio codec over I2C (refreshes the shadow)
+ *
+ * Waits behind everything already queued, so it returns the value after
+ * those writes.
  * @param reg 16-bit register address
  * @param val Pointer to store the read value
  * @return I2C_SUCCESS on success, I2C_FAIL on failure
  */
 uint8_t sgtl5000_reg_read(uint16_t reg, uint16_t* val)
 {
-    uint8_t buf[2];
-    if (HAL_I2C_Mem_Read(&hi2c1, SGTL5000_ADDR, reg, I2C_MEMADD_SIZE_16BIT, buf, 2, HAL_MAX_DELAY) != HAL_OK) {
+    sgtl5000_future_t done;
+    sgtl5000_reg_read_async(reg, &done);
+    if (sgtl5000_wait(&done) != I2C_SUCCESS) {
         return I2C_FAIL;
     }
-    *val = ((uint16_t)buf[0] << 8) | buf[1]; // SGTL5000 sends MSB first
+    *val = done.value;
+    uint32_t key = sgtl5000_i2c_lock();
+    sgtl5000_cache_store(reg, *val);
+    sgtl5000_i2c_unlock(key);
     return I2C_SUCCESS;
 }
 
+/**
+ * @brief Get a register value from the shadow, reading the chip only on a miss
+ *
+ * Volatile registers (see sgtl5000_reg_cacheable) are always read from the chip.
+ * @param reg 16-bit register address
+ * @param val Pointer to store the value
+ * @return I2C_SUCCESS on success, I2C_FAIL on failure
+ */
+uint8_t sgtl5000_reg_get(uint16_t reg, uint16_t* val)
+{
+    if (sgtl5000_cache_lookup(reg, val)) {
+        return I2C_SUCCESS;
+    }
+    return sgtl5000_reg_read(reg, val);
+}
+
+/**
+ * @brief Load the shadow from the chip for every register the driver configures
+ *
+ * Called first in sgtl5000_init(), so later modifies keep the bits the
+ * driver does not own even after an MCU-only reset.
+ * @return I2C_SUCCESS on success, I2C_FAIL on failure
+ */
+uint8_t sgtl5000_cache_fill(void)
+{
+    // All reads queued at once, they run back to back on the I2C interrupts
+    static sgtl5000_future_t done[sizeof(cache_fill_regs) / sizeof(cache_fill_regs[0])];
+    for (uint32_t i = 0; i < sizeof(cache_fill_regs) / sizeof(cache_fill_regs[0]); i++) {
+        sgtl5000_reg_read_async(cache_fill_regs[i], &done[i]);
+    }
+    uint8_t status = I2C_SUCCESS;
+    for (uint32_t i = 0; i < sizeof(cache_fill_regs) / sizeof(cache_fill_regs[0]); i++) {
+        if (sgtl5000_wait(&done[i]) != I2C_SUCCESS) {
+            status = I2C_FAIL;
+            continue;
+        }
+        uint32_t key = sgtl5000_i2c_lock();
+        sgtl5000_cache_store(cache_fill_regs[i], done[i].value);
+        sgtl5000_i2c_unlock(key);
+    }
+    return status;
+}
+
+/**
+ * @brief Forget the whole shadow, the next access to each register reads the chip
+ */
+void sgtl5000_cache_invalidate(void)
+{
+    uint32_t key = sgtl5000_i2c_lock();
+    for (uint32_t i = 0; i < sizeof(reg_valid) / sizeof(reg_valid[0]); i++) {
+        reg_valid[i] = 0;
+    }
+    sgtl5000_i2c_unlock(key);
+}
+
+/**
+ * @brief Enable the I2C read-back of _verify writes (debug)
+ */
+void sgtl5000_set_verify(bool enable)
+{
+    verify_writes = enable;
+}
+
+bool sgtl5000_get_verify(void)
+{
+    return verify_writes;
+}
+
 /**
  * @brief Write a value to a register of SGTL5000 audio codec
- * 
+ *
+ * Queued, returns before the transfer; failures are reported by
+ * sgtl5000_i2c_poll() and sgtl5000_i2c_flush().
  * @param reg 16-bit register address
  * @param val 16-bit value to write
- * @return I2C_SUCCESS on success, I2C_FAIL on failure
+ * @return I2C_SUCCESS once queued
  */
 uint8_t sgtl5000_reg_write(uint16_t reg, uint16_t val)
 {
-    uint8_t buf[2] = {(uint8_t)(val >> 8), (uint8_t)(val &  0xFF)}; // Prepare data in MSB first format
-    if (HAL_I2C_Mem_Write(&hi2c1, SGTL5000_ADDR, reg, I2C_MEMADD_SIZE_16BIT, buf, 2, HAL_MAX_DELAY) != HAL_OK) {
-        return I2C_FAIL;
-    }
-    return I2C_SUCCESS;
+    return sgtl5000_reg_write_async(reg, val, NULL);
+}
+
+/**
+ * @brief Write consecutive registers of SGTL5000 audio codec in one transaction
+ *
+ * Queued like sgtl5000_reg_write(), e.g. all five DAP_EQ_BANDx registers.
+ * @param reg First 16-bit register address
+ * @param vals Values for reg, reg + 2, ...
+ * @param count Number of registers, 1..SGTL5000_I2C_BURST_MAX
+ * @return I2C_SUCCESS once queued, I2C_FAIL for an invalid run
+ */
+uint8_t sgtl5000_reg_write_burst(uint16_t reg, const uint16_t* vals, uint8_t count)
+{
+    return sgtl5000_reg_write_burst_async(reg, vals, count, NULL);
 }
 
 /**
  * @brief Write a value to a register and verify the write operation
- * 
+ *
+ * Only verify mode (sgtl5000_set_verify) waits for the write and reads it
+ * back, otherwise this is a queued write like sgtl5000_reg_write().
  * @param reg 16-bit register address
  * @param val 16-bit value to write
  * @return I2C_SUCCESS on success, I2C_FAIL on failure, I2C_MISMATCH if read value does not match written value
  */
 uint8_t sgtl5000_reg_write_verify(uint16_t reg, uint16_t val)
 {
+    if (!verify_writes) {
+        return sgtl5000_reg_write(reg, val);
+    }
+    sgtl5000_future_t done;
     uint8_t status;
-    status = sgtl5000_reg_write(reg, val);
+    sgtl5000_reg_write_async(reg, val, &done);
+    status = sgtl5000_wait(&done);
     if (status != I2C_SUCCESS) {
         return status; // Return if write operation failed
     }
@@ -57,6 +836,9 @@ uint8_t sgtl5000_reg_write_verify(uint16_t reg, uint16_t val)
         return status; // Return if write/read operation failed
     }
     if (read_val != val) {
+        uint32_t key = sgtl5000_i2c_lock();
+        sgtl5000_cache_store(reg, val); // Keep what the driver intended, the next modify rewrites it
+        sgtl5000_i2c_unlock(key);
         printf("Expected 0x%04X, but read 0x%04X from register 0x%04X\r\n", val, read_val, reg);
         return I2C_MISMATCH; // Return if read value does not match written value
     }
@@ -66,7 +848,9 @@ uint8_t sgtl5000_reg_write_verify(uint16_t reg, uint16_t val)
 
 /**
  * @brief Modify specific bits in a register of SGTL5000 audio codec
- * 
+ *
+ * The current value comes from the shadow, so this is a single I2C write
+ * once the register is cached, and none if the bits already hold the value.
  * @param reg 16-bit register address
  * @param mask 16-bit mask to update the register
  * @param shift Number of bits to shift the value
@@ -77,18 +861,22 @@ uint8_t  sgtl5000_reg_modify(uint16_t reg, uint16_t mask, uint8_t shift, uint16_
 {
     uint16_t current_val;
     uint8_t status;
-    status = sgtl5000_reg_read(reg, &current_val);
+    status = sgtl5000_reg_get(reg, &current_val);
     if (status != I2C_SUCCESS) {
         return status; // Return if read operation failed
     }
     uint16_t new_val = (current_val & ~mask) | ((value << shift) & mask);
+    if (new_val == current_val && sgtl5000_reg_cacheable(reg)) {
+        return I2C_SUCCESS; // The shadow says the chip already holds it
+    }
     status |= sgtl5000_reg_write(reg, new_val);
     return status; 
 }
 
 /**
  * @brief Modify specific bits in a register and verify the modification
- * 
+ *
+ * Same as sgtl5000_reg_modify(), plus a read-back in verify mode.
  * @param reg 16-bit register address
  * @param mask 16-bit mask to update the register
  * @param shift Number of bits to shift the value
@@ -99,11 +887,14 @@ uint8_t sgtl5000_reg_modify_verify(uint16_t reg, uint16_t mask, uint8_t shift, u
 {
     uint16_t current_val;
     uint8_t status;
-    status = sgtl5000_reg_read(reg, &current_val);
+    status = sgtl5000_reg_get(reg, &current_val);
     if (status != I2C_SUCCESS) {
         return status; // Return if read operation failed
     }
     uint16_t new_val = (current_val & ~mask) | ((value << shift) & mask);
+    if (new_val == current_val && !verify_writes && sgtl5000_reg_cacheable(reg)) {
+        return I2C_SUCCESS;
+    }
     status = sgtl5000_reg_write_verify(reg, new_val);
     if (status != I2C_SUCCESS) {
         return status; // Return if verify operation failed
@@ -144,111 +935,6 @@ uint8_t  sgtl5000_print_all_regs()
     return I2C_SUCCESS;
 }
 
-// Helper functions for initialization steps
-
-/**
- * @brief Power up the analog blocks of SGTL5000 audio codec
- * @return I2C_SUCCESS on success, I2C_FAIL on failure
- */
-uint8_t sgtl5000_powerup_analog()
-{
-    uint8_t status;
-
-    // Turn of startup power supplies (VDDD is externally driven)
-    status = sgtl5000_reg_write_verify(SGTL5000_CHIP_ANA_POWER, 0x4060);
-    if (status != I2C_SUCCESS) {
-        printf("Failed to write to SGTL5000_CHIP_ANA_POWER 1\r\n");
-        return status;
-    }
-
-    // Configure reference voltage and bias current
-    status = sgtl5000_reg_write_verify(SGTL5000_CHIP_REF_CTRL, 0x004E); // Set bias current
-    if (status != I2C_SUCCESS) {
-        printf("Failed to write to SGTL5000_CHIP_REF_CTRL 2\r\n");
-        return status;
-    }
-
-    status = sgtl5000_reg_write_verify(SGTL5000_CHIP_LINE_OUT_CTRL, 0x0F22); // Set lineout reference voltage to VDDIO / 2 (1.65V)
-    if (status != I2C_SUCCESS) {
-        printf("Failed to write to SGTL5000_CHIP_LINE_OUT_CTRL 3\r\n");
-        return status;
-    }
-
-    // Short detect configuration
-    status = sgtl5000_reg_write_verify(SGTL5000_CHIP_SHORT_CTRL, 0x1106);
-    if (status != I2C_SUCCESS) {
-        printf("Failed to write to SGTL5000_CHIP_SHORT_CTRL 4\r\n");
-        return status;
-    }
-
-    // Final analog power up after limits are set
-    status = sgtl5000_reg_write_verify(SGTL5000_CHIP_ANA_POWER, 0x40FB);
-    if (status != I2C_SUCCESS) {
-        printf("Failed to write to SGTL5000_CHIP_ANA_POWER 5\r\n");
-        return status;
-    }
-
-    return I2C_SUCCESS;
-}
-
-/**
- * @brief Power up the digital blocks of SGTL5000 audio codec
- * @return I2C_SUCCESS on success, I2C_FAIL on failure
- */
-uint8_t sgtl5000_powerup_digital()
-{
-    uint8_t status = sgtl5000_reg_write_verify(SGTL5000_CHIP_DIG_POWER, 0x0073);
-    if (status != I2C_SUCCESS) {
-        printf("Failed to write to SGTL5000_CHIP_DIG_POWER 6\r\n");
-        return status;
-    }
-    return I2C_SUCCESS;
-}
-
-/**
- * @brief Configure the clocks of SGTL5000 audio codec
- * @return I2C_SUCCESS on success, I2C_FAIL on failure
- */
-uint8_t sgtl5000_configure_clocks()
-{
-    // MCLK = 12.288MHz, Fs = 48kHz
-    uint8_t status = sgtl5000_reg_write_verify(SGTL5000_CHIP_CLK_CTRL, 0x0008);
-    if (status != I2C_SUCCESS) {
-        printf("Failed to write to SGTL5000_CHIP_CLK_CTRL 8\r\n");
-        return status;
-    }
-    return I2C_SUCCESS;
-}
-
-/**
- * @brief Configure the I2S interface of SGTL5000 audio codec
- * @return I2C_SUCCESS on success, I2C_FAIL on failure
- */
-uint8_t sgtl5000_configure_i2s()
-{
-    // SCLKFREQ=64Fs, MS=Slave, SCLK_INV=0, DLEN=16, I2S mode via LRALIGN=0, LRPOL=0
-    uint8_t status = sgtl5000_reg_write_verify(SGTL5000_CHIP_I2S_CTRL, 0X0080);
-    if (status != I2C_SUCCESS) {
-        printf("Failed to write to SGTL5000_CHIP_I2S_CTRL 9\r\n");
-        return status;
-    }
-    return I2C_SUCCESS;
-}
-
-/**
- * @brief Configure the routing of SGTL5000 audio codec
- * @return I2C_SUCCESS on success, I2C_FAIL on failure
- */
-uint8_t sgtl5000_configure_routing()
-{
-    uint8_t status = sgtl5000_reg_write_verify(SGTL5000_CHIP_SSS_CTRL, 0x0030);
-    if (status != I2C_SUCCESS) {
-        printf("Failed to write to SGTL5000_CHIP_SSS_CTRL 10\r\n");
-        return status;
-    }
-    return I2C_SUCCESS;
-}
-
 /**
  * @brief Change the volume of SGTL5000 audio code
  * @param volume_percent Volume percentage (0-100)
@@ -300,9 +986,17 @@ uint8_t sgtl5000_dap_surround_set(sgtl_surround_mode_t mode, uint8_t width)
         width = 7;  // Max width is 7
     }
     
-    sgtl5000_dac_mute(true); // Mute DAC during configuration
     uint16_t surround_val = ((uint16_t)width << 4) | (mode & 0x3);
-    uint8_t status;
+    uint16_t current;
+    uint8_t status = sgtl5000_reg_get(SGTL5000_DAP_SURROUND, &current);
+    if (status != I2C_SUCCESS) {
+        printf("Failed to read SGTL5000_DAP_SURROUND\r\n");
+        return status;
+    }
+    if (current == surround_val) {
+        return I2C_SUCCESS; // No mute/unmute for a no-op
+    }
+    sgtl5000_dac_mute(true); // Mute DAC during configuration
     status = sgtl5000_reg_write_verify(SGTL5000_DAP_SURROUND, surround_val); // 0x010A
     if (status != I2C_SUCCESS) {
         printf("Failed to write to SGTL5000_DAP_SURROUND\r\n");
@@ -314,107 +1008,298 @@ uint8_t sgtl5000_dap_surround_set(sgtl_surround_mode_t mode, uint8_t width)
 
 /**
  * @brief Enable or disable bass enhancement
+ *
+ * The level ramps on the ramp engine: when enabling from off it starts at
+ * the least boost (0x7F) and glides to the target, when already on it
+ * glides from the current level. Returns before the ramp has played out.
  * @param enable true to enable, false to disable
  * @param bass_level Bass enhancement level (0-127, where 0 is max boost and 127 is min boost)
  */
 uint8_t sgtl5000_dap_bass_enhance_set(bool enable, uint8_t lr_level, uint8_t bass_level)
 {
-    uint8_t status = I2C_SUCCESS;
+    uint8_t status;
+    uint32_t key;
     if (bass_level > 0x7F) bass_level = 0x7F;  // clamp to field
 
-    sgtl5000_dac_mute(true); // Mute DAC during configuration
+    status = sgtl5000_ramp_prepare();
+    if (status != I2C_SUCCESS) {
+        printf("Failed to read SGTL5000_DAP_BASS_ENHANCE_CTRL\r\n");
+        return status;
+    }
 
-    if (enable) {
+    // Hold the bass ramp where it is
+    key = sgtl5000_i2c_lock();
+    sgtl5000_ramp_begin();
+    ramp_bass_goal = ramp_bass_now;
+    sgtl5000_i2c_unlock(key);
 
-        // Adjust the LR value
-        status = sgtl5000_reg_modify_verify(SGTL5000_DAP_BASS_ENHANCE_CTRL, 0x3F00, 8, lr_level & 0x3F);
+    if (!enable) {
+        // disable, leave CTRL as-is
+        status = sgtl5000_reg_modify_verify(SGTL5000_DAP_BASS_ENHANCE, 0x0001, 0, 0);
         if (status != I2C_SUCCESS) {
-            printf("Failed to set LR level\r\n");
-            sgtl5000_dac_mute(false);
-            return status;
+            printf("Failed to disable bass enhance\r\n");
         }
+        return status;
+    }
+
+    // Adjust the LR value
+    status = sgtl5000_reg_modify_verify(SGTL5000_DAP_BASS_ENHANCE_CTRL, 0x3F00, 8, lr_level & 0x3F);
+    if (status != I2C_SUCCESS) {
+        printf("Failed to set LR level\r\n");
+        return status;
+    }
 
-        uint16_t ctrl16;
-        status = sgtl5000_reg_read(SGTL5000_DAP_BASS_ENHANCE_CTRL, &ctrl16);
+    uint16_t en16;
+    status = sgtl5000_reg_get(SGTL5000_DAP_BASS_ENHANCE, &en16);
+    if (status != I2C_SUCCESS) {
+        printf("Failed to read SGTL5000_DAP_BASS_ENHANCE\r\n");
+        return status;
+    }
+    if (!(en16 & 0x0001)) {
+        // least boost (0x7F) BEFORE enabling, then enable (preserves cutoff/HPF/etc.)
+        status = sgtl5000_reg_modify_verify(SGTL5000_DAP_BASS_ENHANCE_CTRL, 0x007F, 0, 0x7F);
+        if (status == I2C_SUCCESS) {
+            status = sgtl5000_reg_modify_verify(SGTL5000_DAP_BASS_ENHANCE, 0x0001, 0, 1);
+        }
         if (status != I2C_SUCCESS) {
-            printf("Failed to read SGTL5000_DAP_BASS_ENHANCE_CTRL\r\n");
-            sgtl5000_dac_mute(false);
+            printf("Failed to enable bass enhance\r\n");
             return status;
         }
+    }
+
+    // glide to the target (decreasing code = more boost)
+    key = sgtl5000_i2c_lock();
+    if (!(en16 & 0x0001)) {
+        ramp_bass_now = 0x7F;
+    }
+    ramp_bass_goal = bass_level;
+    sgtl5000_i2c_unlock(key);
+    return I2C_SUCCESS;
+}
 
-        // current 7-bit BASS_LEVEL (0x00 = most boost, 0x7F = least)
-        uint8_t curr = (uint8_t)(ctrl16 & 0x007F);
-        uint8_t next = curr;
 
-        // ramp up to least boost (0x7F) BEFORE enabling
-        uint8_t steps = (uint8_t)(0x7F - curr);
-        for (uint8_t i = 0; i < steps; i++) {
-            next++;
-            status = sgtl5000_reg_modify_verify(SGTL5000_DAP_BASS_ENHANCE_CTRL, 0x007F, 0, next);
-            if (status != I2C_SUCCESS) { sgtl5000_dac_mute(false); return status; }
+// PEQ bands uploaded since init; the chip's filter contents are unknown
+// before that, so the first enable loads every band from peq_coef
+static bool peq_loaded;
+
+// Last coefficients of every PEQ band, pass-through until a band is set.
+// They survive a codec re-init, so the bands come back with PEQ mode.
+static int32_t peq_coef[SGTL5000_PEQ_BANDS][5];
+static bool peq_coef_valid;
+
+/**
+ * @brief Design a PEQ band as codec fixed-point biquad coefficients
+ *
+ * RBJ cookbook at SGTL5000_PEQ_FS, normalised to a0 = 1. The codec runs
+ * y = b0 x + b1 x1 + b2 x2 + a1 y1 + a2 y2, so a1/a2 are stored negated.
+ * @param type Filter type
+ * @param fc Centre/corner frequency in Hz
+ * @param q Quality factor (peak, shelves: slope as Q)
+ * @param gain_db Gain for peak and shelves
+ * @param coef Output b0, b1, b2, a1, a2 in 20-bit fixed point
+ * @return false if the filter is unstable or a coefficient does not fit 20 bits
+ */
+bool sgtl5000_peq_design(sgtl_peq_type_t type, float fc, float q, float gain_db, int32_t coef[5])
+{
+    float b[3] = {1.0f, 0.0f, 0.0f};
+    float a[3] = {1.0f, 0.0f, 0.0f};
+
+    if (type != SGTL_PEQ_FLAT) {
+        if (!(fc > 0.0f && fc < 0.5f * SGTL5000_PEQ_FS) || !(q > 0.0f)) {
+            return false;
+        }
+        float A = powf(10.0f, gain_db / 40.0f);
+        float w0 = 2.0f * 3.14159265f * fc / SGTL5000_PEQ_FS;
+        float cw = cosf(w0);
+        float alpha = sinf(w0) / (2.0f * q);
+        float sa = 2.0f * sqrtf(A) * alpha;
+
+        switch (type) {
+        case SGTL_PEQ_PEAK:
+            b[0] = 1.0f + alpha * A;  b[1] = -2.0f * cw;  b[2] = 1.0f - alpha * A;
+            a[0] = 1.0f + alpha / A;  a[1] = -2.0f * cw;  a[2] = 1.0f - alpha / A;
+            break;
+        case SGTL_PEQ_LOWSHELF:
+            b[0] = A * ((A + 1.0f) - (A - 1.0f) * cw + sa);
+            b[1] = 2.0f * A * ((A - 1.0f) - (A + 1.0f) * cw);
+            b[2] = A * ((A + 1.0f) - (A - 1.0f) * cw - sa);
+            a[0] = (A + 1.0f) + (A - 1.0f) * cw + sa;
+            a[1] = -2.0f * ((A - 1.0f) + (A + 1.0f) * cw);
+            a[2] = (A + 1.0f) + (A - 1.0f) * cw - sa;
+            break;
+        case SGTL_PEQ_HIGHSHELF:
+            b[0] = A * ((A + 1.0f) + (A - 1.0f) * cw + sa);
+            b[1] = -2.0f * A * ((A - 1.0f) + (A + 1.0f) * cw);
+            b[2] = A * ((A + 1.0f) + (A - 1.0f) * cw - sa);
+            a[0] = (A + 1.0f) - (A - 1.0f) * cw + sa;
+            a[1] = 2.0f * ((A - 1.0f) - (A + 1.0f) * cw);
+            a[2] = (A + 1.0f) - (A - 1.0f) * cw - sa;
+            break;
+        case SGTL_PEQ_LOWPASS:
+            b[0] = 0.5f * (1.0f - cw);  b[1] = 1.0f - cw;  b[2] = b[0];
+            a[0] = 1.0f + alpha;  a[1] = -2.0f * cw;  a[2] = 1.0f - alpha;
+            break;
+        case SGTL_PEQ_HIGHPASS:
+            b[0] = 0.5f * (1.0f + cw);  b[1] = -(1.0f + cw);  b[2] = b[0];
+            a[0] = 1.0f + alpha;  a[1] = -2.0f * cw;  a[2] = 1.0f - alpha;
+            break;
+        case SGTL_PEQ_NOTCH:
+            b[0] = 1.0f;  b[1] = -2.0f * cw;  b[2] = 1.0f;
+            a[0] = 1.0f + alpha;  a[1] = -2.0f * cw;  a[2] = 1.0f - alpha;
+            break;
+        default:
+            return false;
         }
+    }
 
-        // enable (preserves cutoff/HPF/etc.)
-        status = sgtl5000_reg_modify_verify(SGTL5000_DAP_BASS_ENHANCE, 0x0001, 0, 1);
-        if (status != I2C_SUCCESS) {
-            printf("Failed to enable bass enhance\r\n"); 
-            sgtl5000_dac_mute(false); 
-            return status;
+    float norm = 1.0f / a[0];
+    float v[5] = {b[0] * norm, b[1] * norm, b[2] * norm, -a[1] * norm, -a[2] * norm};
+
+    // Poles inside the unit circle (in the negated convention)
+    if (!(fabsf(v[4]) < 1.0f && fabsf(v[3]) < 1.0f - v[4])) {
+        return false;
+    }
+    for (uint8_t i = 0; i < 5; i++) {
+        float scaled = roundf(v[i] * (float)(1L << SGTL5000_PEQ_COEF_FRAC));
+        if (scaled > (float)SGTL5000_PEQ_COEF_MAX || scaled < (float)(-SGTL5000_PEQ_COEF_MAX - 1)) {
+            return false;
         }
+        coef[i] = (int32_t)scaled;
+    }
+    return true;
+}
 
-        // ramp down from 0x7F to target (decreasing code = more boost)
-        next  = 0x7F;
-        steps = (uint8_t)(0x7F - bass_level);
-        for (uint8_t i = 0; i < steps; i++) {
-            next--;
-            status = sgtl5000_reg_modify_verify(SGTL5000_DAP_BASS_ENHANCE_CTRL, 0x007F, 0, next);
-            if (status != I2C_SUCCESS) {
-                printf("Failed to set bass level\r\n");
-                sgtl5000_dac_mute(false); 
-                return status; 
-            }
+/**
+ * @brief Queue the upload of one PEQ band through the coefficient access handshake
+ *
+ * Two burst writes (B0 at 0x010E..0x0110, B1..A2 at 0x012C..0x013A), then
+ * FLT_COEF_ACCESS WR | index, which swaps all five coefficients in at once.
+ */
+static uint8_t sgtl5000_peq_upload(uint8_t band, const int32_t coef[5])
+{
+    uint16_t words[2 * 5];
+    for (uint8_t i = 0; i < 5; i++) {
+        uint32_t c = (uint32_t)coef[i] & 0xFFFFFU;
+        words[2 * i]      = (uint16_t)(c >> 4);  // MSB: bits 19:4
+        words[2 * i + 1U] = (uint16_t)(c & 0xF); // LSB: bits 3:0
+    }
+    uint8_t status = sgtl5000_reg_write_burst(SGTL5000_DAP_COEF_WR_B0_MSB, &words[0], 2);
+    if (status == I2C_SUCCESS) {
+        status = sgtl5000_reg_write_burst(SGTL5000_DAP_COEF_WR_B1_MSB, &words[2], 8);
+    }
+    if (status == I2C_SUCCESS) {
+        status = sgtl5000_reg_write(SGTL5000_DAP_FLT_COEF_ACCESS, DAP_FLT_COEF_ACCESS_WR | band);
+    }
+    return status;
+}
+
+/**
+ * @brief Switch the DAP EQ to the 7-band PEQ (all bands in use, unset ones pass-through)
+ *
+ * After init (boot or a hot re-init) the bands are loaded from peq_coef first.
+ * @return I2C_SUCCESS on success, I2C_FAIL on failure
+ */
+uint8_t sgtl5000_dap_peq_enable(void)
+{
+    uint8_t status = I2C_SUCCESS;
+    if (!peq_coef_valid) {
+        for (uint8_t band = 0; band < SGTL5000_PEQ_BANDS; band++) {
+            sgtl5000_peq_design(SGTL_PEQ_FLAT, 0.0f, 0.0f, 0.0f, peq_coef[band]);
+        }
+        peq_coef_valid = true;
+    }
+    if (!peq_loaded) {
+        for (uint8_t band = 0; band < SGTL5000_PEQ_BANDS && status == I2C_SUCCESS; band++) {
+            status = sgtl5000_peq_upload(band, peq_coef[band]);
         }
-    } else {
-        // disable, leave CTRL as-is
-        status = sgtl5000_reg_modify_verify(SGTL5000_DAP_BASS_ENHANCE, 0x0001, 0, 0);
         if (status != I2C_SUCCESS) {
-            printf("Failed to disable bass enhance\r\n");
-            sgtl5000_dac_mute(false);
+            printf("Failed to load SGTL5000 PEQ coefficients\r\n");
             return status;
         }
+        peq_loaded = true;
+    }
+
+    status = sgtl5000_reg_modify(SGTL5000_DAP_PEQ, DAP_PEQ_EN_MASK, 0, SGTL5000_PEQ_BANDS);
+    if (status != I2C_SUCCESS) {
+        printf("Failed to write to SGTL5000_DAP_PEQ\r\n");
+        return status;
+    }
+    return sgtl5000_dap_eq_mode_set(DAP_AUDIO_EQ_PEQ);
+}
+
+/**
+ * @brief Design one PEQ band on the MCU and load it into the codec
+ *
+ * Switches the DAP EQ to PEQ mode (leaving the 5-band GEQ). The band
+ * changes in one step, the codec swaps the coefficients in atomically.
+ * @param band Band 0..6
+ * @param type Filter type, SGTL_PEQ_FLAT clears the band
+ * @param fc Frequency in Hz
+ * @param q Quality factor
+ * @param gain_db Gain in dB for peak and shelves
+ * @return I2C_SUCCESS on success, I2C_FAIL on failure or unusable filter
+ */
+uint8_t sgtl5000_dap_peq_set_band(uint8_t band, sgtl_peq_type_t type, float fc, float q, float gain_db)
+{
+    int32_t coef[5];
+    if (band >= SGTL5000_PEQ_BANDS || !sgtl5000_peq_design(type, fc, q, gain_db, coef)) {
+        printf("Failed to design PEQ band %u\r\n", band);
+        return I2C_FAIL;
+    }
+    uint8_t status = sgtl5000_dap_peq_enable();
+    if (status != I2C_SUCCESS) {
+        return status;
+    }
+    for (uint8_t i = 0; i < 5; i++) {
+        peq_coef[band][i] = coef[i]; // Kept for the reload after a codec re-init
+    }
+    status = sgtl5000_peq_upload(band, coef);
+    if (status != I2C_SUCCESS) {
+        printf("Failed to load PEQ band %u\r\n", band);
     }
-
-    sgtl5000_dac_mute(false);
     return status;
 }
 
-
 /**
- * @brief Bypass the EQ of SGTL5000 audio codec
+ * @brief Switch the DAP EQ mode at runtime without a DAC mute
+ *
+ * Band modes (GEQ, tone) fade their bands to flat around the switch on the
+ * ramp engine; returns before the switch has happened.
+ * @param mode DAP_AUDIO_EQ_BYPASS, _PEQ, _TONE or _GEQ
  * @return I2C_SUCCESS on success, I2C_FAIL on failure
  */
-uint8_t sgtl5000_dap_eq_bypass(void)
+uint8_t sgtl5000_dap_eq_mode_set(uint8_t mode)
 {
-    sgtl5000_dac_mute(true); // Mute DAC during configuration
-    uint8_t status;
-    status = sgtl5000_reg_write_verify(SGTL5000_DAP_AUDIO_EQ, 0x0000); // Bypass EQ
+    static const uint8_t flat[5] = {RAMP_BAND_FLAT, RAMP_BAND_FLAT, RAMP_BAND_FLAT, RAMP_BAND_FLAT, RAMP_BAND_FLAT};
+    if (mode > DAP_AUDIO_EQ_GEQ) {
+        return I2C_FAIL;
+    }
+    uint8_t status = sgtl5000_ramp_prepare();
     if (status != I2C_SUCCESS) {
-        printf("Failed to write to SGTL5000_DAP_AUDIO_EQ for EQ bypass\r\n");
+        printf("Failed to read SGTL5000_DAP_AUDIO_EQ\r\n");
+        return status;
     }
-    sgtl5000_dac_mute(false); // Unmute DAC after configuration
+    if (sgtl5000_dap_eq_mode_get() == mode) {
+        return I2C_SUCCESS;
+    }
+    uint32_t key = sgtl5000_i2c_lock();
+    sgtl5000_ramp_eq(mode, flat, 0);
+    sgtl5000_i2c_unlock(key);
     return I2C_SUCCESS;
 }
 
+/**
+ * @brief Bypass the EQ of SGTL5000 audio codec
+ * @return I2C_SUCCESS on success, I2C_FAIL on failure
+ */
+uint8_t sgtl5000_dap_eq_bypass(void)
+{
+    return sgtl5000_dap_eq_mode_set(DAP_AUDIO_EQ_BYPASS);
+}
+
 uint8_t sgtl5000_dap_geq_enable(void)
 {
-    sgtl5000_dac_mute(true); // Mute DAC during configuration
-    uint8_t status;
-    status = sgtl5000_reg_write_verify(SGTL5000_DAP_AUDIO_EQ, 0x0003); // Enable EQ
-    if (status != I2C_SUCCESS) {
-        printf("Failed to write to SGTL5000_DAP_AUDIO_EQ for EQ enable\r\n");
-    }
-    sgtl5000_dac_mute(false); // Unmute DAC after configuration
-    return I2C_SUCCESS;
+    return sgtl5000_dap_eq_mode_set(DAP_AUDIO_EQ_GEQ);
 }
 
 uint16_t sgtl5000_geq_code_from_db(int8_t db)
@@ -439,45 +1324,30 @@ uint16_t sgtl5000_geq_code_from_db(int8_t db)
 
 
 
+/**
+ * @brief Ramp one GEQ band to a register code on the ramp engine
+ * @param band_reg SGTL5000_DAP_EQ_BAND0..4
+ * @param target Band code (0x00..0x5F, 0x2F = 0 dB)
+ * @return I2C_SUCCESS once the ramp is set up, I2C_FAIL on failure
+ */
 uint8_t sgtl5000_dap_geq_ramp_band(uint16_t band_reg, uint16_t target)
 {
-    uint8_t  status;
-    uint16_t value;
-
-    status = sgtl5000_reg_read(band_reg, &value);
-    if (status != I2C_SUCCESS) { 
-        return status; 
+    if (band_reg < SGTL5000_DAP_EQ_BAND0 || band_reg > SGTL5000_DAP_EQ_BAND4 || (band_reg & 1U)) {
+        return I2C_FAIL;
     }
-
-    uint16_t curr = value & 0x007F;
-    uint16_t goal = target;
-    if (goal > 0x5F) {
-         goal = 0x5F; 
+    if (target > 0x5F) {
+         target = 0x5F;
     } // Clamp to max
 
-    if (curr == goal) {
-         return I2C_SUCCESS;
-    }
-
-    uint16_t num_steps;
-    int8_t   dir;
-    if (goal > curr) {
-        num_steps = (uint16_t)(goal - curr);
-        dir   = +1;
-    } else {
-        num_steps = (uint16_t)(curr - goal);
-        dir   = -1;
+    uint8_t status = sgtl5000_ramp_prepare();
+    if (status != I2C_SUCCESS) {
+        return status;
     }
 
-    uint16_t next = curr;
-    for (uint16_t i = 0; i < num_steps; i++) {
-        next = (uint16_t)(next + dir);
-        status = sgtl5000_reg_modify_verify(band_reg, 0x007F, 0, next);
-        if (status != I2C_SUCCESS) {
-             return status; 
-        }
-        HAL_Delay(1); // Small delay 
-    }
+    uint32_t key = sgtl5000_i2c_lock();
+    sgtl5000_ramp_begin();
+    ramp_geq_goal[(band_reg - SGTL5000_DAP_EQ_BAND0) / 2U] = (uint8_t)target;
+    sgtl5000_i2c_unlock(key);
     return I2C_SUCCESS;
 }
 
@@ -485,6 +1355,10 @@ uint8_t sgtl5000_dap_geq_ramp_band(uint16_t band_reg, uint16_t target)
 
 /**
  * @brief Set the GEQ bands of SGTL5000 audio codec
+ *
+ * All five bands glide together on the ramp engine, one 0.25 dB step per
+ * ms, so even a full-range change is over in under 100 ms. Returns before
+ * the ramp has played out, see sgtl5000_ramp_remaining().
  * @param b0_db Gain for Band 0 in dB (-12 to +12)
  * @param b1_db Gain for Band 1 in dB (-12 to +12)
  * @param b2_db Gain for Band 2 in dB (-12 to +12)
@@ -493,212 +1367,540 @@ uint8_t sgtl5000_dap_geq_ramp_band(uint16_t band_reg, uint16_t target)
  */
 uint8_t sgtl5000_dap_geq_set_bands_db(int8_t b0_db, int8_t b1_db, int8_t b2_db, int8_t b3_db, int8_t b4_db)
 {
-    uint8_t  status;
-    uint16_t b0_code;
-    uint16_t b1_code;
-    uint16_t b2_code;
-    uint16_t b3_code;
-    uint16_t b4_code;
+    uint8_t status;
 
-    // Convert dB values to register codes
-    b0_code = sgtl5000_geq_code_from_db(b0_db);
-    b1_code = sgtl5000_geq_code_from_db(b1_db);
-    b2_code = sgtl5000_geq_code_from_db(b2_db);
-    b3_code = sgtl5000_geq_code_from_db(b3_db);
-    b4_code = sgtl5000_geq_code_from_db(b4_db);
+    status = sgtl5000_ramp_prepare();
+    if (status != I2C_SUCCESS) {
+        return status;
+    }
 
-    // Mute DAC during configuration
-    sgtl5000_dac_mute(true);
+    // Convert dB values to register codes
+    uint8_t goal[5];
+    goal[0] = (uint8_t)sgtl5000_geq_code_from_db(b0_db);
+    goal[1] = (uint8_t)sgtl5000_geq_code_from_db(b1_db);
+    goal[2] = (uint8_t)sgtl5000_geq_code_from_db(b2_db);
+    goal[3] = (uint8_t)sgtl5000_geq_code_from_db(b3_db);
+    goal[4] = (uint8_t)sgtl5000_geq_code_from_db(b4_db);
+
+    // Switches to the GEQ through flat if another EQ mode is active
+    uint32_t key = sgtl5000_i2c_lock();
+    sgtl5000_ramp_eq(DAP_AUDIO_EQ_GEQ, goal, 0x1F);
+    sgtl5000_i2c_unlock(key);
+    return I2C_SUCCESS;
+}
 
-    // Enable GEQ if not already enabled
-    status = sgtl5000_dap_geq_enable();
+/**
+ * @brief Set the tone control (bass/treble) of SGTL5000 audio codec
+ *
+ * Tone-control mode uses only DAP_EQ_BAND0 (bass shelf) and DAP_EQ_BAND4
+ * (treble shelf), 2 registers per step instead of 5 for the GEQ. The levels
+ * glide on the ramp engine; switching in from another EQ mode fades through
+ * flat rather than muting the DAC.
+ * @param bass_db Bass gain in dB (-12 to +12)
+ * @param treble_db Treble gain in dB (-12 to +12)
+ * @return I2C_SUCCESS once the ramp is set up, I2C_FAIL on failure
+ */
+uint8_t sgtl5000_dap_tone_set_db(int8_t bass_db, int8_t treble_db)
+{
+    uint8_t status = sgtl5000_ramp_prepare();
     if (status != I2C_SUCCESS) {
-        sgtl5000_dac_mute(false);
         return status;
     }
 
-    status = sgtl5000_dap_geq_ramp_band(SGTL5000_DAP_EQ_BAND0, b0_code);
-    if (status != I2C_SUCCESS) { 
-        sgtl5000_dac_mute(false); 
-        return status; 
-    }
+    uint8_t goal[5] = {RAMP_BAND_FLAT, RAMP_BAND_FLAT, RAMP_BAND_FLAT, RAMP_BAND_FLAT, RAMP_BAND_FLAT};
+    goal[0] = (uint8_t)sgtl5000_geq_code_from_db(bass_db);
+    goal[4] = (uint8_t)sgtl5000_geq_code_from_db(treble_db);
+
+    uint32_t key = sgtl5000_i2c_lock();
+    sgtl5000_ramp_eq(DAP_AUDIO_EQ_TONE, goal, 0x11);
+    sgtl5000_i2c_unlock(key);
+    return I2C_SUCCESS;
+}
 
-    status = sgtl5000_dap_geq_ramp_band(SGTL5000_DAP_EQ_BAND1, b1_code);
-    if (status != I2C_SUCCESS) { 
-        sgtl5000_dac_mute(false); 
-        return status; 
+/**
+ * @brief Convert an AVC rate in dB/s to a 12-bit ATTACK/DECAY code
+ * @param dbps Rate in dB/s
+ * @param db_per_lsb Register scale, SGTL5000_AVC_ATTACK_DB_LSB or SGTL5000_AVC_DECAY_DB_LSB
+ * @return Register code, 1..SGTL5000_AVC_RATE_MAX
+ */
+static uint16_t sgtl5000_avc_rate_code(float dbps, float db_per_lsb)
+{
+    float code = dbps / db_per_lsb + 0.5f;
+    if (!(code >= 1.0f)) {
+        return 1; // A zero rate would freeze the gain
+    }
+    if (code > (float)SGTL5000_AVC_RATE_MAX) {
+        return SGTL5000_AVC_RATE_MAX;
     }
+    return (uint16_t)code;
+}
 
-    status = sgtl5000_dap_geq_ramp_band(SGTL5000_DAP_EQ_BAND2, b2_code);
-    if (status != I2C_SUCCESS) { 
-        sgtl5000_dac_mute(false); 
-        return status; 
+/**
+ * @brief Convert AVC settings to the DAP_AVC_CTRL and THRESHOLD/ATTACK/DECAY register values
+ * @param avc Settings; values are clamped to what the registers can encode
+ * @param ctrl_out DAP_AVC_CTRL
+ * @param vals DAP_AVC_THRESHOLD, _ATTACK, _DECAY
+ */
+static void sgtl5000_avc_encode(const sgtl5000_avc_t* avc, uint16_t* ctrl_out, uint16_t vals[3])
+{
+    float thresh_db = avc->threshold_db;
+    if (!(thresh_db >= SGTL5000_AVC_THRESH_MIN_DB)) {
+        thresh_db = SGTL5000_AVC_THRESH_MIN_DB;
+    }
+    if (thresh_db > 0.0f) {
+        thresh_db = 0.0f;
     }
 
-    status = sgtl5000_dap_geq_ramp_band(SGTL5000_DAP_EQ_BAND3, b3_code);
-    if (status != I2C_SUCCESS) { 
-        sgtl5000_dac_mute(false); 
-        return status; 
+    vals[0] = (uint16_t)(SGTL5000_AVC_THRESH_0DB * powf(10.0f, thresh_db / 20.0f) + 0.5f);
+    vals[1] = sgtl5000_avc_rate_code(avc->attack_dbps, SGTL5000_AVC_ATTACK_DB_LSB);
+    vals[2] = sgtl5000_avc_rate_code(avc->decay_dbps, SGTL5000_AVC_DECAY_DB_LSB);
+
+    uint16_t max_gain = avc->max_gain_db / 6U;
+    if (max_gain > 2U) {
+        max_gain = 2U;
+    }
+    // LBI_RESPONSE stays 0 (0 ms), as the driver always configured it
+    uint16_t ctrl = (uint16_t)(max_gain << DAP_AVC_CTRL_MAX_GAIN_SHIFT);
+    if (avc->hard_limit) {
+        ctrl |= DAP_AVC_CTRL_HARD_LIMIT_EN;
     }
+    if (avc->enable) {
+        ctrl |= DAP_AVC_CTRL_EN;
+    }
+    *ctrl_out = ctrl;
+}
+
+/**
+ * @brief Set the automatic volume control (AVC) of SGTL5000 audio codec
+ *
+ * The codec levels the DAP output by itself, no MCU cycles per sample.
+ * Threshold, attack and decay go out as one burst before AVC_CTRL, so the
+ * limiter never runs on a mix of old and new settings.
+ * @param avc Settings; values are clamped to what the registers can encode
+ * @return I2C_SUCCESS on success, I2C_FAIL on failure, I2C_MISMATCH if the AVC_CTRL read back differs
+ */
+uint8_t sgtl5000_dap_avc_set(const sgtl5000_avc_t* avc)
+{
+    uint16_t ctrl;
+    uint16_t vals[3];
+    sgtl5000_avc_encode(avc, &ctrl, vals);
 
-    status = sgtl5000_dap_geq_ramp_band(SGTL5000_DAP_EQ_BAND4, b4_code);
+    uint8_t status = sgtl5000_reg_write_burst(SGTL5000_DAP_AVC_THRESHOLD, vals, 3);
     if (status != I2C_SUCCESS) {
-        sgtl5000_dac_mute(false);
+        printf("Failed to write to SGTL5000_DAP_AVC_THRESHOLD..DECAY\r\n");
+        return status;
+    }
+    status = sgtl5000_reg_write_verify(SGTL5000_DAP_AVC_CTRL, ctrl);
+    if (status != I2C_SUCCESS) {
+        printf("Failed to write to SGTL5000_DAP_AVC_CTRL\r\n");
         return status;
     }
-
-    // Unmute DAC after configuration
-    sgtl5000_dac_mute(false);
     return I2C_SUCCESS;
 }
 
-
- 
-
 /**
- * @brief Configure the DSP of SGTL5000 audio codec
+ * @brief Read back the applied AVC settings of SGTL5000 audio codec
+ *
+ * Decodes the register shadow, so the values are what the codec holds after
+ * clamping and rounding, not what was asked for.
+ * @param avc Output settings
  * @return I2C_SUCCESS on success, I2C_FAIL on failure
  */
-uint8_t sgtl5000_configure_dsp()
+uint8_t sgtl5000_dap_avc_get(sgtl5000_avc_t* avc)
 {
-    uint8_t status;
-    status = sgtl5000_reg_write_verify(SGTL5000_DAP_CTRL, 0x0001);
+    uint16_t ctrl, thresh, attack, decay;
+    uint8_t status = sgtl5000_reg_get(SGTL5000_DAP_AVC_CTRL, &ctrl);
+    status |= sgtl5000_reg_get(SGTL5000_DAP_AVC_THRESHOLD, &thresh);
+    status |= sgtl5000_reg_get(SGTL5000_DAP_AVC_ATTACK, &attack);
+    status |= sgtl5000_reg_get(SGTL5000_DAP_AVC_DECAY, &decay);
     if (status != I2C_SUCCESS) {
-        printf("Failed to write to SGTL5000_DAP_CTRL 11\r\n");
-        return status;
+        printf("Failed to read AVC registers\r\n");
+        return I2C_FAIL;
     }
-    HAL_Delay(50);
-    status = sgtl5000_reg_write_verify(SGTL5000_DAP_AUDIO_EQ, 0x0003);
-    if (status != I2C_SUCCESS) {
-        printf("Failed to write to SGTL5000_DAP_AUDIO_EQ 12\r\n");
-        return status;
+
+    avc->enable = (ctrl & DAP_AVC_CTRL_EN) != 0U;
+    avc->hard_limit = (ctrl & DAP_AVC_CTRL_HARD_LIMIT_EN) != 0U;
+    avc->max_gain_db = (uint8_t)(((ctrl & DAP_AVC_CTRL_MAX_GAIN_MASK) >> DAP_AVC_CTRL_MAX_GAIN_SHIFT) * 6U);
+    if (thresh == 0U) {
+        avc->threshold_db = SGTL5000_AVC_THRESH_MIN_DB;
     }
-    HAL_Delay(50);
-    status = sgtl5000_reg_write_verify(SGTL5000_DAP_AVC_THRESHOLD, 0x0A40);
-    if (status != I2C_SUCCESS) {
-        printf("Failed to write to SGTL5000_DAP_AVC_THRESHOLD 13\r\n");
-        return status;
+    else {
+        avc->threshold_db = 20.0f * log10f((float)thresh / SGTL5000_AVC_THRESH_0DB);
     }
-    HAL_Delay(50);
-    status = sgtl5000_reg_write_verify(SGTL5000_DAP_AVC_ATTACK, 0x0014);
-    if (status != I2C_SUCCESS) {
-        printf("Failed to write to SGTL5000_DAP_AVC_ATTACK 14\r\n");
+    avc->attack_dbps = (float)(attack & SGTL5000_AVC_RATE_MAX) * SGTL5000_AVC_ATTACK_DB_LSB;
+    avc->decay_dbps = (float)(decay & SGTL5000_AVC_RATE_MAX) * SGTL5000_AVC_DECAY_DB_LSB;
+    return I2C_SUCCESS;
+}
+
+/**
+ * @brief Queue a scene register write only if the shadow holds a different value
+ */
+static uint8_t sgtl5000_scene_write(uint16_t reg, uint16_t val, uint8_t* changed)
+{
+    uint16_t current;
+    uint8_t status = sgtl5000_reg_get(reg, &current);
+    if (status != I2C_SUCCESS || current == val) {
         return status;
     }
-    HAL_Delay(50);
-    status = sgtl5000_reg_write_verify(SGTL5000_DAP_AVC_DECAY, 0x0028);
+    (*changed)++;
+    status = sgtl5000_reg_write_verify(reg, val);
     if (status != I2C_SUCCESS) {
-        printf("Failed to write to SGTL5000_DAP_AVC_DECAY 15\r\n");
-        return status;
+        printf("Failed to write to register 0x%04X\r\n", reg);
     }
-    HAL_Delay(50);
-    status = sgtl5000_reg_write_verify(SGTL5000_DAP_AVC_CTRL, 0x0001);
-    
-    HAL_Delay(50);
+    return status;
+}
+
+/**
+ * @brief Capture the current codec state as a scene
+ *
+ * Taken from the register shadow; running ramps report their goals, so
+ * get + modify + apply never fights a ramp in progress.
+ * @param scene Output scene
+ * @return I2C_SUCCESS on success, I2C_FAIL on failure
+ */
+uint8_t sgtl5000_scene_get(sgtl5000_scene_t* scene)
+{
+    uint16_t bass_en, bass_ctrl, surround;
+    uint8_t status = sgtl5000_ramp_prepare();
+    status |= sgtl5000_reg_get(SGTL5000_DAP_BASS_ENHANCE, &bass_en);
+    status |= sgtl5000_reg_get(SGTL5000_DAP_SURROUND, &surround);
+    status |= sgtl5000_reg_get(SGTL5000_CHIP_SSS_CTRL, &scene->routing);
+    status |= sgtl5000_reg_get(SGTL5000_CHIP_DAC_VOL, &scene->dac_vol);
+    status |= sgtl5000_reg_get(SGTL5000_CHIP_ANA_HP_CTRL, &scene->hp_vol);
+    status |= sgtl5000_reg_get(SGTL5000_CHIP_LINE_OUT_VOL, &scene->line_out_vol);
+    if (status != I2C_SUCCESS || sgtl5000_dap_avc_get(&scene->avc) != I2C_SUCCESS) {
+        printf("Failed to read the SGTL5000 scene\r\n");
+        return I2C_FAIL;
+    }
+
+    uint32_t key = sgtl5000_i2c_lock();
+    scene->eq_mode = sgtl5000_ramp_eq_target(scene->eq_band);
+    bass_ctrl = 0;
+    sgtl5000_cache_lookup(SGTL5000_DAP_BASS_ENHANCE_CTRL, &bass_ctrl);
+    scene->bass_level = ramp_running ? ramp_bass_goal : (uint8_t)(bass_ctrl & 0x007F);
+    sgtl5000_i2c_unlock(key);
+
+    scene->bass_enable = (bass_en & 0x0001) != 0U;
+    scene->bass_lr_level = (uint8_t)((bass_ctrl >> 8) & 0x3F);
+    scene->surround_mode = (sgtl_surround_mode_t)(surround & 0x3);
+    scene->surround_width = (uint8_t)((surround >> 4) & 0x7);
     return I2C_SUCCESS;
 }
 
 /**
- * @brief Set initial volume and levels of SGTL5000 audio codec
+ * @brief Bring the codec to a scene with the fewest register writes
+ *
+ * Every register is compared with the shadow (or the goal of a running
+ * ramp) and only the ones that differ are queued, in this order: routing,
+ * AVC (rates before the enable), surround, bass enhance, EQ, volumes. EQ
+ * bands and the bass level glide on the ramp engine, an EQ mode change
+ * fades through flat; nothing mutes the DAC except a surround change.
+ * PEQ band coefficients are not part of a scene, entering PEQ mode reloads
+ * them from RAM if the codec lost them.
+ * @param scene Desired state
+ * @param changed Output number of registers that differed, may be NULL
  * @return I2C_SUCCESS on success, I2C_FAIL on failure
  */
-uint8_t sgtl5000_set_levels()
+uint8_t sgtl5000_scene_apply(const sgtl5000_scene_t* scene, uint8_t* changed)
 {
-    uint8_t status;
-    status = sgtl5000_reg_write_verify(SGTL5000_CHIP_ANA_ADC_CTRL, 0x0000);
+    uint8_t n = 0;
+    uint8_t status = sgtl5000_ramp_prepare();
     if (status != I2C_SUCCESS) {
-        printf("Failed to write to SGTL5000_CHIP_ANA_ADC_CTRL 17\r\n");
+        printf("Failed to read SGTL5000_DAP_AUDIO_EQ\r\n");
         return status;
     }
-    HAL_Delay(50);
-    status = sgtl5000_reg_write_verify(SGTL5000_CHIP_DAC_VOL, 0x3C3C);
-    if (status != I2C_SUCCESS) {
-        printf("Failed to write to SGTL5000_CHIP_DAC_VOL 18\r\n");
-        return status;
+
+    status = sgtl5000_scene_write(SGTL5000_CHIP_SSS_CTRL, scene->routing, &n);
+
+    uint16_t avc_ctrl;
+    uint16_t avc_vals[3];
+    sgtl5000_avc_encode(&scene->avc, &avc_ctrl, avc_vals);
+    for (uint8_t i = 0; i < 3 && status == I2C_SUCCESS; i++) {
+        status = sgtl5000_scene_write((uint16_t)(SGTL5000_DAP_AVC_THRESHOLD + 2U * i), avc_vals[i], &n);
     }
-    HAL_Delay(50);
-    status = sgtl5000_reg_write_verify(SGTL5000_CHIP_LINE_OUT_VOL, 0x0606);
-    if (status != I2C_SUCCESS) {
-        printf("Failed to write to SGTL5000_CHIP_LINE_OUT_VOL 19\r\n");
-        return status;
+    if (status == I2C_SUCCESS) {
+        status = sgtl5000_scene_write(SGTL5000_DAP_AVC_CTRL, avc_ctrl, &n);
     }
-    HAL_Delay(50);
-    status = sgtl5000_reg_write_verify(SGTL5000_CHIP_ANA_HP_CTRL, 0x1818);
-    if (status != I2C_SUCCESS) {
-        printf("Failed to write to SGTL5000_CHIP_ANA_HP_CTRL 20\r\n");
-        return status;
+
+    // Surround and bass setters skip themselves when nothing differs
+    uint16_t surround, bass_en, bass_ctrl;
+    if (status == I2C_SUCCESS) {
+        status = sgtl5000_reg_get(SGTL5000_DAP_SURROUND, &surround);
+        status |= sgtl5000_reg_get(SGTL5000_DAP_BASS_ENHANCE, &bass_en);
+        status |= sgtl5000_reg_get(SGTL5000_DAP_BASS_ENHANCE_CTRL, &bass_ctrl);
     }
-    HAL_Delay(50);
-    status = sgtl5000_reg_write_verify(SGTL5000_CHIP_ADCDAC_CTRL, 0x0000);
-    if (status != I2C_SUCCESS) {
-        printf("Failed to write to SGTL5000_CHIP_ADCDAC_CTRL 21\r\n");
-        return status;
+    if (status == I2C_SUCCESS) {
+        uint8_t width = (scene->surround_width > 7) ? 7 : scene->surround_width;
+        if (surround != (uint16_t)(((uint16_t)width << 4) | (scene->surround_mode & 0x3))) {
+            n++;
+            status = sgtl5000_dap_surround_set(scene->surround_mode, width);
+        }
     }
-    HAL_Delay(50);
-    status = sgtl5000_reg_write_verify(SGTL5000_CHIP_ANA_CTRL, 0x0004);
-    if (status != I2C_SUCCESS) {
-        printf("Failed to write to SGTL5000_CHIP_ANA_CTRL 22\r\n");
-        return status;
+    if (status == I2C_SUCCESS) {
+        bool bass_on = (bass_en & 0x0001) != 0U;
+        uint8_t level = (scene->bass_level > 0x7F) ? 0x7F : scene->bass_level;
+        uint32_t key = sgtl5000_i2c_lock();
+        uint8_t level_now = ramp_running ? ramp_bass_goal : (uint8_t)(bass_ctrl & 0x007F);
+        sgtl5000_i2c_unlock(key);
+        uint8_t bass_diff = (uint8_t)(bass_on != scene->bass_enable);
+        if (scene->bass_enable) {
+            bass_diff += (uint8_t)(((bass_ctrl >> 8) & 0x3F) != (scene->bass_lr_level & 0x3F));
+            bass_diff += (uint8_t)(level_now != level);
+        }
+        if (bass_diff) {
+            n += bass_diff;
+            status = sgtl5000_dap_bass_enhance_set(scene->bass_enable, scene->bass_lr_level, level);
+        }
     }
 
-    return I2C_SUCCESS;
+    if (status == I2C_SUCCESS) {
+        uint8_t mode = scene->eq_mode & DAP_AUDIO_EQ_EN_MASK;
+        uint8_t mask = (mode == DAP_AUDIO_EQ_GEQ) ? 0x1F : (mode == DAP_AUDIO_EQ_TONE) ? 0x11 : 0x00;
+        uint8_t goal[5];
+        uint8_t band[5];
+        for (uint8_t i = 0; i < 5; i++) {
+            goal[i] = (mask & (1U << i)) ? ((scene->eq_band[i] > 0x5F) ? 0x5F : scene->eq_band[i]) : RAMP_BAND_FLAT;
+        }
+        uint32_t key = sgtl5000_i2c_lock();
+        uint8_t mode_now = sgtl5000_ramp_eq_target(band);
+        uint8_t eq_diff = (uint8_t)(mode_now != mode);
+        for (uint8_t i = 0; i < 5; i++) {
+            eq_diff += (uint8_t)((mask & (1U << i)) && band[i] != goal[i]);
+        }
+        if (eq_diff && mode != DAP_AUDIO_EQ_PEQ) {
+            sgtl5000_ramp_eq(mode, goal, mask);
+        }
+        sgtl5000_i2c_unlock(key);
+        n += eq_diff;
+        if (eq_diff && mode == DAP_AUDIO_EQ_PEQ) {
+            status = sgtl5000_dap_peq_enable();
+        }
+    }
+
+    if (status == I2C_SUCCESS) {
+        status = sgtl5000_scene_write(SGTL5000_CHIP_DAC_VOL, scene->dac_vol, &n);
+    }
+    if (status == I2C_SUCCESS) {
+        status = sgtl5000_scene_write(SGTL5000_CHIP_ANA_HP_CTRL, scene->hp_vol, &n);
+    }
+    if (status == I2C_SUCCESS) {
+        status = sgtl5000_scene_write(SGTL5000_CHIP_LINE_OUT_VOL, scene->line_out_vol, &n);
+    }
+    if (changed != NULL) {
+        *changed = n;
+    }
+    return status;
 }
 
+// Codec init sequence
+//
+// One entry per register write, run phase by phase and flushed at the end of
+// each phase so sgtl5000_init() can time it. No write needs a fixed wait:
+// the only settling time is the VAG ramp before LINEOUT/HP unmute, and that
+// is a deadline counted from the analog power-up, so the clock, DAP and level
+// writes all run inside it. The design does not use the PLL, so there is no
+// CHIP_ANA_STATUS bit to poll instead.
+#define INIT_CHECK      0x01 // Read back after the phase, also outside verify mode
+#define INIT_VAG_START  0x02 // VAG starts ramping with this write
+#define INIT_VAG_WAIT   0x04 // Hold this write until SGTL5000_VAG_RAMP_MS after INIT_VAG_START
+
+typedef struct {
+    uint16_t reg;
+    uint16_t val;
+    uint8_t  phase; // sgtl5000_boot_phase_t
+    uint8_t  flags;
+} sgtl5000_init_step_t;
+
+static const sgtl5000_init_step_t init_steps[] = {
+    // Startup power supplies off (VDDD is externally driven), bias, LINEOUT
+    // reference VDDIO / 2 (1.65V), short detect, then analog power up
+    {SGTL5000_CHIP_ANA_POWER,     0x4060, SGTL5000_BOOT_POWER,  INIT_CHECK},
+    {SGTL5000_CHIP_REF_CTRL,      0x004E, SGTL5000_BOOT_POWER,  0},
+    {SGTL5000_CHIP_LINE_OUT_CTRL, 0x0F22, SGTL5000_BOOT_POWER,  0},
+    {SGTL5000_CHIP_SHORT_CTRL,    0x1106, SGTL5000_BOOT_POWER,  0},
+    {SGTL5000_CHIP_ANA_POWER,     0x40FB, SGTL5000_BOOT_POWER,  INIT_CHECK | INIT_VAG_START},
+    {SGTL5000_CHIP_DIG_POWER,     0x0073, SGTL5000_BOOT_POWER,  INIT_CHECK},
+    {SGTL5000_CHIP_LINE_OUT_VOL,  0x0606, SGTL5000_BOOT_POWER,  0},
+    // MCLK = 12.288MHz, Fs = 48kHz; I2S slave to the STM32 I2S2 master (16 bit
+    // frames, SCLK = 32Fs), 16 bit; I2S_IN -> DAP -> DAC
+    {SGTL5000_CHIP_CLK_CTRL,      0x0008, SGTL5000_BOOT_CLOCKS, INIT_CHECK},
+    {SGTL5000_CHIP_I2S_CTRL,      0x0130, SGTL5000_BOOT_CLOCKS, INIT_CHECK},
+    {SGTL5000_CHIP_SSS_CTRL,      0x0070, SGTL5000_BOOT_CLOCKS, 0},
+    // DAP on, GEQ mode, AVC at -18 dBFS, 16 dB/s attack, 2 dB/s decay (see sgtl5000_dap_avc_set)
+    {SGTL5000_DAP_CTRL,           0x0001, SGTL5000_BOOT_DSP,    0},
+    {SGTL5000_DAP_AUDIO_EQ,       0x0003, SGTL5000_BOOT_DSP,    0},
+    {SGTL5000_DAP_AVC_THRESHOLD,  0x0A40, SGTL5000_BOOT_DSP,    0},
+    {SGTL5000_DAP_AVC_ATTACK,     0x0014, SGTL5000_BOOT_DSP,    0},
+    {SGTL5000_DAP_AVC_DECAY,      0x0028, SGTL5000_BOOT_DSP,    0},
+    {SGTL5000_DAP_AVC_CTRL,       0x0001, SGTL5000_BOOT_DSP,    INIT_CHECK},
+    // Initial levels, LINEOUT/HP unmuted last
+    {SGTL5000_CHIP_ANA_ADC_CTRL,  0x0000, SGTL5000_BOOT_LEVELS, 0},
+    {SGTL5000_CHIP_DAC_VOL,       0x3C3C, SGTL5000_BOOT_LEVELS, 0},
+    {SGTL5000_CHIP_LINE_OUT_VOL,  0x0606, SGTL5000_BOOT_LEVELS, 0},
+    {SGTL5000_CHIP_ANA_HP_CTRL,   0x1818, SGTL5000_BOOT_LEVELS, 0},
+    {SGTL5000_CHIP_ADCDAC_CTRL,   0x0000, SGTL5000_BOOT_LEVELS, 0},
+    {SGTL5000_CHIP_ANA_CTRL,      0x0004, SGTL5000_BOOT_LEVELS, INIT_CHECK | INIT_VAG_WAIT},
+};
+
+#define INIT_STEP_COUNT (sizeof(init_steps) / sizeof(init_steps[0]))
+
+static const char* const boot_phase_names[SGTL5000_BOOT_PHASES] = {
+    "cache", "power", "clocks", "dsp", "levels",
+};
+
+static uint32_t boot_cycles[SGTL5000_BOOT_PHASES];
+static uint32_t boot_vag_wait_ms;
+
+// Health monitor, see sgtl5000_health_task()
+static sgtl5000_health_t health = {.last_reason = ""};
+static sgtl5000_scene_t  health_scene;        // Last state seen on a healthy codec, replayed after a recovery
+static bool              health_scene_valid;
+static bool              health_armed;        // Init ran once, health_dig_power is known
+static uint16_t          health_dig_power;    // CHIP_DIG_POWER as configured
+static bool              health_pending;      // Check reads queued
+static uint32_t          health_last;         // HAL tick of the last check
+static sgtl5000_future_t health_id, health_status, health_power;
+
 /**
- * @brief Initialize the SGTL5000 audio codec with the provided configuration
- * 
- * @param config Pointer to the SGTL5000 configuration structure
+ * @brief Queue the init steps of one phase and wait for them to reach the chip
+ * @param phase sgtl5000_boot_phase_t
+ * @param vag_start HAL tick of the VAG power-up, set by the phase that contains it
+ * @return I2C_SUCCESS on success, I2C_FAIL on failure, I2C_MISMATCH if a checked register reads back different
  */
-uint8_t  sgtl5000_init()
+static uint8_t sgtl5000_init_phase(uint8_t phase, uint32_t* vag_start)
 {
-    uint8_t status;
-    
-    // Analog Power Up
-    status = sgtl5000_powerup_analog();
-    if (status != I2C_SUCCESS) {
-        printf("Failed to power up analog blocks\r\n");
-        return status;
+    static sgtl5000_future_t check[INIT_STEP_COUNT];
+    bool read_back = !verify_writes; // Verify mode already reads back every write
+    bool vag = false;
+    uint8_t status = I2C_SUCCESS;
+
+    for (uint32_t i = 0; i < INIT_STEP_COUNT && status == I2C_SUCCESS; i++) {
+        const sgtl5000_init_step_t* step = &init_steps[i];
+        if (step->phase != phase) {
+            continue;
+        }
+        if (step->flags & INIT_VAG_WAIT) {
+            uint32_t elapsed = HAL_GetTick() - *vag_start;
+            if (elapsed < SGTL5000_VAG_RAMP_MS) {
+                boot_vag_wait_ms = SGTL5000_VAG_RAMP_MS - elapsed;
+                sgtl5000_queue_delay((uint16_t)boot_vag_wait_ms);
+            }
+        }
+        status = sgtl5000_reg_write_verify(step->reg, step->val);
+        if (status == I2C_SUCCESS && read_back && (step->flags & INIT_CHECK)) {
+            status = sgtl5000_reg_read_async(step->reg, &check[i]);
+        }
+        if (status != I2C_SUCCESS) {
+            printf("Failed to write to register 0x%04X\r\n", step->reg);
+        }
+        vag |= (step->flags & INIT_VAG_START) != 0U;
     }
-    // Digital Power Up
-    status = sgtl5000_powerup_digital();
     if (status != I2C_SUCCESS) {
-        printf("Failed to power up digital blocks\r\n");
         return status;
     }
-    // Start LINEOUT volume at 0dB
-    status = sgtl5000_reg_write_verify(SGTL5000_CHIP_LINE_OUT_VOL, 0x0606);
+    status = sgtl5000_i2c_flush();
     if (status != I2C_SUCCESS) {
-        printf("Failed to write to SGTL5000_CHIP_LINE_OUT_VOL 7\r\n");
         return status;
     }
-    // Clock Configuration
-    status = sgtl5000_configure_clocks();
-    if (status != I2C_SUCCESS) {
-        printf("Failed to configure clocks\r\n");
-        return status;
+    if (vag) {
+        *vag_start = HAL_GetTick(); // Not earlier than the write itself
     }
-    // I2S Configuration
-    status = sgtl5000_configure_i2s();
-    if (status != I2C_SUCCESS) {
-        printf("Failed to configure I2S\r\n");
-        return status;
+
+    for (uint32_t i = 0; i < INIT_STEP_COUNT && read_back; i++) {
+        const sgtl5000_init_step_t* step = &init_steps[i];
+        if (step->phase != phase || !(step->flags & INIT_CHECK)) {
+            continue;
+        }
+        if (check[i].status != I2C_SUCCESS) {
+            return I2C_FAIL;
+        }
+        if (check[i].value != step->val) {
+            printf("Expected 0x%04X, but read 0x%04X from register 0x%04X\r\n", step->val, check[i].value, step->reg);
+            return I2C_MISMATCH;
+        }
     }
-    // Routing Configuration
-    status = sgtl5000_configure_routing();
-    if (status != I2C_SUCCESS) {
-        printf("Failed to configure routing\r\n");
-        return status;
+    return I2C_SUCCESS;
+}
+
+/**
+ * @brief Name of a codec init phase, for the boot shell command
+ */
+const char* sgtl5000_boot_phase_name(uint8_t phase)
+{
+    return (phase < SGTL5000_BOOT_PHASES) ? boot_phase_names[phase] : "";
+}
+
+/**
+ * @brief Duration of a codec init phase in the last init (boot or hot re-init), in us (DWT)
+ */
+uint32_t sgtl5000_boot_phase_us(uint8_t phase)
+{
+    if (phase >= SGTL5000_BOOT_PHASES) {
+        return 0;
     }
-    // DSP Configuration
-    status = sgtl5000_configure_dsp();
+    return (uint32_t)(((uint64_t)boot_cycles[phase] * 1000000ULL) / PERF_CLOCK_HZ);
+}
+
+/**
+ * @brief Part of the levels phase spent waiting for the VAG ramp, in ms
+ */
+uint32_t sgtl5000_boot_vag_wait_ms(void)
+{
+    return boot_vag_wait_ms;
+}
+
+/**
+ * @brief Read the shadow and run the init table, timing every phase
+ *
+ * Shared by the boot init and the health monitor's hot re-init.
+ * @return I2C_SUCCESS on success, I2C_FAIL on failure, I2C_MISMATCH if a checked register reads back different
+ */
+static uint8_t sgtl5000_init_sequence(void)
+{
+    uint8_t status;
+
+    // Register shadow first, so every modify below is a single write
+    uint32_t start = perf_cycles();
+    sgtl5000_cache_invalidate();
+    uint32_t key = sgtl5000_i2c_lock();
+    ramp_running = false;
+    ramp_mode_next = -1;
+    sgtl5000_i2c_unlock(key);
+    peq_loaded = false;
+    boot_vag_wait_ms = 0;
+    status = sgtl5000_cache_fill();
+    boot_cycles[SGTL5000_BOOT_CACHE] = perf_cycles() - start;
     if (status != I2C_SUCCESS) {
-        printf("Failed to configure DSP\r\n");
+        printf("Failed to read the SGTL5000 registers\r\n");
         return status;
     }
-    // Set initial levels
-    status = sgtl5000_set_levels();
+
+    uint32_t vag_start = HAL_GetTick();
+    for (uint8_t phase = SGTL5000_BOOT_POWER; phase < SGTL5000_BOOT_PHASES; phase++) {
+        start = perf_cycles();
+        status = sgtl5000_init_phase(phase, &vag_start);
+        boot_cycles[phase] = perf_cycles() - start;
+        if (status != I2C_SUCCESS) {
+            printf("Failed to run SGTL5000 init phase %s\r\n", boot_phase_names[phase]);
+            return status;
+        }
+    }
+
+    // Power state the health monitor expects; a brownout resets it
+    sgtl5000_cache_lookup(SGTL5000_CHIP_DIG_POWER, &health_dig_power);
+    health_armed = true;
+    return I2C_SUCCESS;
+}
+
+/**
+ * @brief Initialize the SGTL5000 audio codec with the provided configuration
+ * 
+ * @param config Pointer to the SGTL5000 configuration structure
+ */
+uint8_t  sgtl5000_init()
+{
+    uint8_t status = sgtl5000_init_sequence();
     if (status != I2C_SUCCESS) {
-        printf("Failed to set initial levels\r\n");
         return status;
     }
     /*
@@ -725,3 +1927,193 @@ uint8_t  sgtl5000_init()
     
     return I2C_SUCCESS;
 }
+
+// Codec health monitor
+//
+// Every SGTL5000_HEALTH_PERIOD_MS the main loop queues reads of CHIP_ID,
+// CHIP_ANA_STATUS and CHIP_DIG_POWER and checks them once they complete,
+// so a check never blocks. A failed or wrong read means the bus is stuck
+// (ESD, hot-plug glitch): the slave is clocked free and I2C1 is reset. A
+// CHIP_DIG_POWER back at its reset value means the codec browned out and
+// lost its registers: the init table runs again. Either way the last scene
+// seen on a healthy codec is then replayed as a minimal diff.
+
+/**
+ * @brief Busy-wait on the DWT cycle counter (bus recovery bit-banging)
+ */
+static void sgtl5000_delay_us(uint32_t us)
+{
+    uint32_t start = perf_cycles();
+    uint32_t cycles = us * (SystemCoreClock / 1000000U);
+    while ((perf_cycles() - start) < cycles) {
+    }
+}
+
+/**
+ * @brief Free a stuck I2C bus and reset I2C1
+ *
+ * Drops every queued transfer (their futures fail), clocks SCL up to 9
+ * times as GPIO until the slave releases SDA, sends a STOP, then resets
+ * the peripheral through RCC and initialises it again, all under the
+ * queue lock.
+ */
+static void sgtl5000_i2c_bus_recover(void)
+{
+    uint32_t key = sgtl5000_i2c_lock();
+    HAL_I2C_DeInit(&hi2c1); // Also disables the I2C interrupts
+    while (i2c_tail != i2c_head) {
+        sgtl5000_i2c_finish(I2C_FAIL);
+    }
+    i2c_active = false;
+
+    // The lock stays held (about 0.1 ms) so SysTick cannot enqueue and start
+    // a transfer on the peripheral while it is down
+    GPIO_InitTypeDef gpio = {0};
+    gpio.Pin = SGTL5000_I2C_SCL_PIN | SGTL5000_I2C_SDA_PIN;
+    gpio.Mode = GPIO_MODE_OUTPUT_OD;
+    gpio.Pull = GPIO_NOPULL;
+    gpio.Speed = GPIO_SPEED_FREQ_LOW;
+    HAL_GPIO_WritePin(SGTL5000_I2C_GPIO_PORT, SGTL5000_I2C_SCL_PIN | SGTL5000_I2C_SDA_PIN, GPIO_PIN_SET);
+    HAL_GPIO_Init(SGTL5000_I2C_GPIO_PORT, &gpio);
+    sgtl5000_delay_us(5);
+
+    // 100 kHz clocks until the slave lets go of SDA
+    for (uint8_t i = 0; i < 9 && HAL_GPIO_ReadPin(SGTL5000_I2C_GPIO_PORT, SGTL5000_I2C_SDA_PIN) == GPIO_PIN_RESET; i++) {
+        HAL_GPIO_WritePin(SGTL5000_I2C_GPIO_PORT, SGTL5000_I2C_SCL_PIN, GPIO_PIN_RESET);
+        sgtl5000_delay_us(5);
+        HAL_GPIO_WritePin(SGTL5000_I2C_GPIO_PORT, SGTL5000_I2C_SCL_PIN, GPIO_PIN_SET);
+        sgtl5000_delay_us(5);
+    }
+    // STOP: SDA rises while SCL is high
+    HAL_GPIO_WritePin(SGTL5000_I2C_GPIO_PORT, SGTL5000_I2C_SCL_PIN, GPIO_PIN_RESET);
+    sgtl5000_delay_us(5);
+    HAL_GPIO_WritePin(SGTL5000_I2C_GPIO_PORT, SGTL5000_I2C_SDA_PIN, GPIO_PIN_RESET);
+    sgtl5000_delay_us(5);
+    HAL_GPIO_WritePin(SGTL5000_I2C_GPIO_PORT, SGTL5000_I2C_SCL_PIN, GPIO_PIN_SET);
+    sgtl5000_delay_us(5);
+    HAL_GPIO_WritePin(SGTL5000_I2C_GPIO_PORT, SGTL5000_I2C_SDA_PIN, GPIO_PIN_SET);
+    sgtl5000_delay_us(5);
+
+    __HAL_RCC_I2C1_FORCE_RESET();
+    __HAL_RCC_I2C1_RELEASE_RESET();
+    HAL_I2C_Init(&hi2c1); // MspInit puts the pins back on I2C1
+    sgtl5000_i2c_unlock(key);
+}
+
+/**
+ * @brief Bring the codec back without an MCU reset and replay the last healthy scene
+ *
+ * Blocks the main loop until the queue drains: a few ms for a scene replay,
+ * and at least SGTL5000_VAG_RAMP_MS plus the init table for a re-init. That
+ * is accepted: the audio path runs on interrupts and the codec is silent
+ * until it is initialised anyway, so only the shell and the spectrum stream
+ * pause, and the time is logged. Re-inits only follow a codec brownout.
+ * @param reason Logged with the recovery
+ * @param bus true to free the bus and reset I2C1 first
+ */
+static void sgtl5000_health_recover(const char* reason, bool bus)
+{
+    uint32_t start = HAL_GetTick();
+    uint8_t changed = 0;
+    bool reinit = false;
+
+    if (bus) {
+        sgtl5000_i2c_bus_recover();
+        health.bus_resets++;
+    }
+    (void)sgtl5000_i2c_flush(); // Errors so far belong to the fault, not to the recovery
+
+    sgtl5000_future_t id, power;
+    sgtl5000_reg_read_async(SGTL5000_CHIP_ID, &id);
+    sgtl5000_reg_read_async(SGTL5000_CHIP_DIG_POWER, &power);
+    uint8_t status = sgtl5000_wait(&id);
+    status |= sgtl5000_wait(&power);
+    if (status != I2C_SUCCESS || (id.value >> 8) != SGTL5000_CHIP_ID_PART) {
+        if (!health.fault) {
+            printf("Codec recovery: %s, codec not responding, retrying every %u ms\r\n", reason, SGTL5000_HEALTH_PERIOD_MS);
+        }
+        health.fault = true;
+        (void)sgtl5000_i2c_flush();
+        return;
+    }
+
+    if (!health_armed || power.value != health_dig_power) {
+        reinit = true;
+        health.reinits++;
+        status = sgtl5000_init_sequence();
+    }
+    else {
+        sgtl5000_cache_invalidate(); // Dropped writes are in the shadow but not on the chip
+    }
+    if (status == I2C_SUCCESS && health_scene_valid) {
+        status = sgtl5000_scene_apply(&health_scene, &changed);
+    }
+    if (status == I2C_SUCCESS) {
+        status = sgtl5000_i2c_flush();
+    }
+
+    bool was_fault = health.fault;
+    health.recoveries++;
+    health.last_reason = reason;
+    health.last_ms = HAL_GetTick() - start;
+    health.fault = (status != I2C_SUCCESS);
+    if (was_fault && health.fault) {
+        return; // Already reported, still retrying
+    }
+    printf("Codec recovery: %s,%s%s %u registers replayed, %lu ms%s\r\n", reason,
+           bus ? " bus reset," : "", reinit ? " re-init (main loop held)," : "", changed,
+           (unsigned long)health.last_ms, health.fault ? ", FAILED" : "");
+}
+
+/**
+ * @brief Periodic codec health check, call from the main loop
+ */
+void sgtl5000_health_task(void)
+{
+    if (!health_pending) {
+        if (HAL_GetTick() - health_last < SGTL5000_HEALTH_PERIOD_MS) {
+            return;
+        }
+        health_last = HAL_GetTick();
+        sgtl5000_reg_read_async(SGTL5000_CHIP_ID, &health_id);
+        sgtl5000_reg_read_async(SGTL5000_CHIP_ANA_STATUS, &health_status);
+        sgtl5000_reg_read_async(SGTL5000_CHIP_DIG_POWER, &health_power);
+        health_pending = true;
+        return;
+    }
+    if (health_id.status == I2C_PENDING || health_status.status == I2C_PENDING || health_power.status == I2C_PENDING) {
+        return;
+    }
+    health_pending = false;
+    health.checks++;
+
+    if (health_id.status != I2C_SUCCESS || health_status.status != I2C_SUCCESS ||
+        health_power.status != I2C_SUCCESS || (health_id.value >> 8) != SGTL5000_CHIP_ID_PART) {
+        sgtl5000_health_recover("I2C fault", true);
+        return;
+    }
+    if (!health_armed || health_power.value != health_dig_power) {
+        sgtl5000_health_recover(health_armed ? "codec reset" : "codec found", false);
+        return;
+    }
+    if (health.fault) {
+        health.fault = false;
+        printf("Codec healthy again\r\n");
+    }
+
+    uint16_t shorts = health_status.value & (CHIP_ANA_STATUS_LRSHORT | CHIP_ANA_STATUS_CSHORT);
+    if (shorts != (health.ana_status & (CHIP_ANA_STATUS_LRSHORT | CHIP_ANA_STATUS_CSHORT))) {
+        printf("Codec headphone short %s (ANA_STATUS 0x%04X)\r\n", shorts ? "detected" : "cleared", health_status.value);
+    }
+    health.ana_status = health_status.value;
+
+    health_scene_valid = (sgtl5000_scene_get(&health_scene) == I2C_SUCCESS);
+}
+
+/**
+ * @brief Health monitor counters
+ */
+void sgtl5000_health_get(sgtl5000_health_t* h)
+{
+    *h = health;
+}
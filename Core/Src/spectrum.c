@@ -0,0 +1,278 @@
+#include "spectrum.h"
+#include <math.h>
+#include <string.h>
+
+#define SPECTRUM_HALF_LEN   (SPECTRUM_FFT_LEN / 2U)
+#define SPECTRUM_PI         3.14159265358979f
+
+// 7-tap half-band decimation filter: h = [C0 0 C1 0.5 C1 0 C0]
+#define HB_TAPS             7U
+#define HB_C0               (-1.0f / 32.0f)
+#define HB_C1               ( 9.0f / 32.0f)
+
+// Constant tables, filled once at init
+static float window[SPECTRUM_FFT_LEN];
+static float tw_re[SPECTRUM_HALF_LEN];
+static float tw_im[SPECTRUM_HALF_LEN];
+static uint16_t band_lo[SPECTRUM_BANDS];
+static uint16_t band_hi[SPECTRUM_BANDS];
+
+// Capture state (audio interrupt context)
+static float hb_hist[HB_TAPS];
+static uint8_t decim_phase = 0;
+static uint32_t fs_decim = 0;
+static volatile uint32_t hop_len = 0;
+static uint32_t hop_pos = 0;
+static bool capturing = false;
+static float frame[SPECTRUM_FFT_LEN];
+
+// Analysis state (low-priority context)
+static float work[SPECTRUM_FFT_LEN]; // SPECTRUM_HALF_LEN complex values, re/im interleaved
+static uint8_t result[SPECTRUM_BANDS];
+
+static volatile bool enabled = false;
+static volatile bool frame_busy = false;   // frame[] is owned by the analyser
+static volatile bool result_ready = false; // result[] is owned by the reader
+
+/**
+ * @brief In-place radix-2 complex FFT
+ * @param buf Interleaved re/im buffer of m complex values
+ * @param m Number of complex points (power of two, at most SPECTRUM_HALF_LEN)
+ */
+static void spectrum_fft_complex(float* buf, uint32_t m)
+{
+    // Bit-reversal permutation
+    for (uint32_t i = 1, j = 0; i < m; i++) {
+        uint32_t bit = m >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            float tr = buf[2 * i];
+            float ti = buf[2 * i + 1];
+            buf[2 * i] = buf[2 * j];
+            buf[2 * i + 1] = buf[2 * j + 1];
+            buf[2 * j] = tr;
+            buf[2 * j + 1] = ti;
+        }
+    }
+
+    // Butterflies, twiddles taken from the N-point table (N = 2m)
+    for (uint32_t len = 2; len <= m; len <<= 1) {
+        uint32_t half = len >> 1;
+        uint32_t step = SPECTRUM_FFT_LEN / len;
+        for (uint32_t i = 0; i < m; i += len) {
+            for (uint32_t k = 0; k < half; k++) {
+                float wr = tw_re[k * step];
+                float wi = tw_im[k * step];
+                float* a = &buf[2 * (i + k)];
+                float* b = &buf[2 * (i + k + half)];
+                float xr = b[0] * wr - b[1] * wi;
+                float xi = b[0] * wi + b[1] * wr;
+                b[0] = a[0] - xr;
+                b[1] = a[1] - xi;
+                a[0] += xr;
+                a[1] += xi;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Initialize the analyser tables for the given stream sample rate
+ * @param sample_rate Output stream sample rate in Hz
+ */
+void spectrum_init(uint32_t sample_rate)
+{
+    fs_decim = sample_rate / SPECTRUM_DECIM;
+
+    // Periodic Hann window
+    for (uint32_t n = 0; n < SPECTRUM_FFT_LEN; n++) {
+        window[n] = 0.5f - 0.5f * cosf(2.0f * SPECTRUM_PI * (float)n / (float)SPECTRUM_FFT_LEN);
+    }
+
+    // Forward twiddles W_N^k
+    for (uint32_t k = 0; k < SPECTRUM_HALF_LEN; k++) {
+        float phase = 2.0f * SPECTRUM_PI * (float)k / (float)SPECTRUM_FFT_LEN;
+        tw_re[k] =  cosf(phase);
+        tw_im[k] = -sinf(phase);
+    }
+
+    // Log-spaced band edges mapped to FFT bins, at least one bin per band
+    float bin_hz = (float)fs_decim / (float)SPECTRUM_FFT_LEN;
+    float ratio  = SPECTRUM_BAND_MAX_HZ / SPECTRUM_BAND_MIN_HZ;
+    for (uint32_t b = 0; b < SPECTRUM_BANDS; b++) {
+        float f_lo = SPECTRUM_BAND_MIN_HZ * powf(ratio, (float)b / (float)SPECTRUM_BANDS);
+        float f_hi = SPECTRUM_BAND_MIN_HZ * powf(ratio, (float)(b + 1) / (float)SPECTRUM_BANDS);
+        int32_t lo = (int32_t)(f_lo / bin_hz + 0.5f);
+        int32_t hi = (int32_t)(f_hi / bin_hz + 0.5f) - 1;
+        if (lo < 1) {
+            lo = 1;
+        }
+        if (lo > (int32_t)SPECTRUM_HALF_LEN - 1) {
+            lo = (int32_t)SPECTRUM_HALF_LEN - 1;
+        }
+        if (hi < lo) {
+            hi = lo;
+        }
+        if (hi > (int32_t)SPECTRUM_HALF_LEN - 1) {
+            hi = (int32_t)SPECTRUM_HALF_LEN - 1;
+        }
+        band_lo[b] = (uint16_t)lo;
+        band_hi[b] = (uint16_t)hi;
+    }
+
+    memset(hb_hist, 0, sizeof(hb_hist));
+    decim_phase = 0;
+    hop_pos = 0;
+    capturing = false;
+    frame_busy = false;
+    result_ready = false;
+    hop_len = fs_decim / SPECTRUM_RATE_DEFAULT;
+}
+
+/**
+ * @brief Enable or disable the analyser
+ * @param enable true to start analysing the output stream
+ * @param rate_hz Band update rate (SPECTRUM_RATE_MIN_HZ..SPECTRUM_RATE_MAX_HZ)
+ */
+void spectrum_enable(bool enable, uint8_t rate_hz)
+{
+    if (rate_hz < SPECTRUM_RATE_MIN_HZ) {
+        rate_hz = SPECTRUM_RATE_MIN_HZ;
+    }
+    if (rate_hz > SPECTRUM_RATE_MAX_HZ) {
+        rate_hz = SPECTRUM_RATE_MAX_HZ;
+    }
+    hop_len = fs_decim / rate_hz; // Always >= SPECTRUM_FFT_LEN, frames never overlap
+    result_ready = false;
+    enabled = enable;
+}
+
+bool spectrum_is_enabled(void)
+{
+    return enabled;
+}
+
+/**
+ * @brief Feed one block of the output stream into the analyser (audio context)
+ * @param left Left channel samples
+ * @param right Right channel samples
+ * @param frames Number of frames in the block
+ * @return true when a full FFT frame has been captured and spectrum_analyse() should run
+ */
+bool spectrum_push(const float* left, const float* right, uint32_t frames)
+{
+    bool ready = false;
+
+    if (!enabled) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < frames; i++) {
+        // Mono downmix into the half-band history
+        for (uint32_t t = HB_TAPS - 1; t > 0; t--) {
+            hb_hist[t] = hb_hist[t - 1];
+        }
+        hb_hist[0] = 0.5f * (left[i] + right[i]);
+
+        if (++decim_phase < SPECTRUM_DECIM) {
+            continue;
+        }
+        decim_phase = 0;
+
+        float y = HB_C0 * (hb_hist[0] + hb_hist[6])
+                + HB_C1 * (hb_hist[2] + hb_hist[4])
+                + 0.5f  *  hb_hist[3];
+
+        // Capture the first SPECTRUM_FFT_LEN samples of every hop, skip if the analyser is late
+        if (hop_pos == 0) {
+            capturing = !frame_busy;
+        }
+        if (capturing && hop_pos < SPECTRUM_FFT_LEN) {
+            frame[hop_pos] = y;
+            if (hop_pos == SPECTRUM_FFT_LEN - 1) {
+                frame_busy = true;
+                capturing = false;
+                ready = true;
+            }
+        }
+        if (++hop_pos >= hop_len) {
+            hop_pos = 0;
+        }
+    }
+    return ready;
+}
+
+/**
+ * @brief Window, transform and reduce the captured frame to band levels (low-priority context)
+ */
+void spectrum_analyse(void)
+{
+    if (!frame_busy) {
+        return;
+    }
+
+    // Pack the real frame as SPECTRUM_HALF_LEN complex points: z[n] = x[2n] + j*x[2n+1]
+    for (uint32_t n = 0; n < SPECTRUM_FFT_LEN; n++) {
+        work[n] = frame[n] * window[n];
+    }
+    frame_busy = false; // Capture buffer can be refilled while we transform
+
+    spectrum_fft_complex(work, SPECTRUM_HALF_LEN);
+
+    // Full-scale sine through a Hann window peaks at N/4
+    const float ref = 1.0f / ((float)SPECTRUM_FFT_LEN * (float)SPECTRUM_FFT_LEN / 16.0f);
+    uint8_t levels[SPECTRUM_BANDS];
+
+    for (uint32_t b = 0; b < SPECTRUM_BANDS; b++) {
+        float power = 0.0f;
+        for (uint32_t k = band_lo[b]; k <= band_hi[b]; k++) {
+            // Split the packed transform into the real-input spectrum X[k]
+            uint32_t kc = SPECTRUM_HALF_LEN - k;
+            float zr = work[2 * k];
+            float zi = work[2 * k + 1];
+            float cr = work[2 * kc];
+            float ci = -work[2 * kc + 1];
+            float er = 0.5f * (zr + cr);
+            float ei = 0.5f * (zi + ci);
+            float or_ = 0.5f * (zi - ci);
+            float oi = -0.5f * (zr - cr);
+            float xr = er + tw_re[k] * or_ - tw_im[k] * oi;
+            float xi = ei + tw_re[k] * oi + tw_im[k] * or_;
+            power += xr * xr + xi * xi;
+        }
+
+        float db = 10.0f * log10f(power * ref + 1e-12f);
+        int32_t level = (int32_t)(db + (float)SPECTRUM_LEVEL_MAX + 0.5f);
+        if (level < 0) {
+            level = 0;
+        }
+        if (level > (int32_t)SPECTRUM_LEVEL_MAX) {
+            level = SPECTRUM_LEVEL_MAX;
+        }
+        levels[b] = (uint8_t)level;
+    }
+
+    // Drop the frame if the reader has not consumed the previous one yet
+    if (!result_ready) {
+        memcpy(result, levels, sizeof(result));
+        result_ready = true;
+    }
+}
+
+/**
+ * @brief Fetch the latest band levels
+ * @param bands Output array of SPECTRUM_BANDS levels (0..SPECTRUM_LEVEL_MAX)
+ * @return true if a new frame was available
+ */
+bool spectrum_read(uint8_t bands[SPECTRUM_BANDS])
+{
+    if (!result_ready) {
+        return false;
+    }
+    memcpy(bands, result, SPECTRUM_BANDS);
+    result_ready = false;
+    return true;
+}
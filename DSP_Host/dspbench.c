@@ -0,0 +1,22 @@
+// Host runner for the DSP kernel benchmark (same table as the 'bench' shell command)
+//
+//   dspbench [reps]
+
+#include "dsp_bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+int main(int argc, char** argv)
+{
+    uint32_t reps = DSP_BENCH_DEFAULT_REPS;
+
+    if (argc > 2) {
+        fprintf(stderr, "usage: dspbench [reps]\n");
+        return 2;
+    }
+    if (argc == 2) {
+        reps = (uint32_t)strtoul(argv[1], NULL, 0);
+    }
+    dsp_bench_run(reps);
+    return 0;
+}
@@ -0,0 +1,140 @@
+#!/usr/bin/env python3
+"""Generate the compact HRTF sets for the MCU virtualiser (Core/Src/dsp_hrtf_sets.c).
+
+The sets come from the Brown-Duda spherical head model: a first-order head
+shadow filter per ear plus the Woodworth interaural delay, for a symmetric
+pair of virtual speakers at +-azimuth. Each set is stored in shuffler form,
+sum = (ipsi + contra) and diff = (ipsi - contra), so the stage needs two
+convolutions instead of four.
+
+    python3 DSP_Host/hrtf_gen.py > Core/Src/dsp_hrtf_sets.c
+"""
+
+import cmath
+import math
+
+FS = 48000.0
+TAPS = 64                 # Must match DSP_HRTF_TAPS
+ONSET = 4                 # Must match DSP_HRTF_ONSET, lead of the ipsilateral path
+HEAD_RADIUS = 0.0875      # m
+SPEED_OF_SOUND = 343.0    # m/s
+ALPHA_MIN = 0.1
+THETA_MIN = math.radians(150.0)
+SINC_HALF = 8             # Half-length of the fractional delay kernel
+FADE = 16                 # Tail fade-out length
+
+SETS = [("30deg", 30.0), ("45deg", 45.0), ("60deg", 60.0)]
+
+
+def shadow_iir(theta):
+    """Bilinear head-shadow section for an incidence angle from the ear axis."""
+    w0 = SPEED_OF_SOUND / HEAD_RADIUS
+    alpha = (1.0 + ALPHA_MIN / 2.0) + (1.0 - ALPHA_MIN / 2.0) * math.cos(theta / THETA_MIN * math.pi)
+    k = 2.0 * FS
+    a0 = 2.0 * w0 + k
+    b0 = (2.0 * w0 + alpha * k) / a0
+    b1 = (2.0 * w0 - alpha * k) / a0
+    a1 = (2.0 * w0 - k) / a0
+    return b0, b1, a1
+
+
+def woodworth_delay(theta):
+    """Arrival time relative to the head centre, in seconds (Brown-Duda form)."""
+    a_c = HEAD_RADIUS / SPEED_OF_SOUND
+    if theta < math.pi / 2.0:
+        return -a_c * math.cos(theta)
+    return a_c * (theta - math.pi / 2.0)
+
+
+def frac_delay(d):
+    """Blackman-windowed sinc delaying by d samples (d >= SINC_HALF)."""
+    h = [0.0] * TAPS
+    for n in range(TAPS):
+        x = n - d
+        if abs(x) > SINC_HALF:
+            continue
+        sinc = 1.0 if abs(x) < 1e-9 else math.sin(math.pi * x) / (math.pi * x)
+        r = (x + SINC_HALF) / (2.0 * SINC_HALF)
+        w = 0.42 - 0.5 * math.cos(2.0 * math.pi * r) + 0.08 * math.cos(4.0 * math.pi * r)
+        h[n] = sinc * w
+    return h
+
+
+def ear_ir(theta, delay):
+    b0, b1, a1 = shadow_iir(theta)
+    x = frac_delay(delay)
+    y = [0.0] * TAPS
+    x1 = y1 = 0.0
+    for n in range(TAPS):
+        y[n] = b0 * x[n] + b1 * x1 - a1 * y1
+        x1, y1 = x[n], y[n]
+    for n in range(FADE):
+        y[TAPS - FADE + n] *= 0.5 * (1.0 + math.cos(math.pi * (n + 1) / FADE))
+    return y
+
+
+def response_peak(h):
+    peak = 0.0
+    for i in range(257):
+        w = math.pi * i / 256.0
+        v = abs(sum(c * cmath.exp(-1j * w * n) for n, c in enumerate(h)))
+        peak = max(peak, v)
+    return peak
+
+
+def make_set(azimuth_deg):
+    az = math.radians(azimuth_deg)
+    theta_ipsi = math.pi / 2.0 - az      # Left speaker to left ear
+    theta_contra = math.pi / 2.0 + az    # Left speaker to right ear
+    t_ipsi = woodworth_delay(theta_ipsi)
+    t_contra = woodworth_delay(theta_contra)
+    # Fractional-delay kernels need SINC_HALF samples of lead, ONSET is the integer part kept
+    lead = SINC_HALF - ONSET
+    d_ipsi = float(ONSET + lead)
+    d_contra = d_ipsi + (t_contra - t_ipsi) * FS
+    ipsi = ear_ir(theta_ipsi, d_ipsi)
+    contra = ear_ir(theta_contra, d_contra)
+    # Drop the common lead so the ipsilateral peak sits at ONSET
+    ipsi = ipsi[lead:] + [0.0] * lead
+    contra = contra[lead:] + [0.0] * lead
+    s = [i + c for i, c in zip(ipsi, contra)]
+    d = [i - c for i, c in zip(ipsi, contra)]
+    # Correlated or anti-correlated full-scale input must not clip
+    g = 1.0 / max(response_peak(s), response_peak(d))
+    s = [v * g if abs(v * g) > 1e-9 else 0.0 for v in s]
+    d = [v * g if abs(v * g) > 1e-9 else 0.0 for v in d]
+    return s, d, (t_contra - t_ipsi) * FS
+
+
+def c_array(name, values):
+    lines = ["static const float %s[DSP_HRTF_TAPS] = {" % name]
+    for i in range(0, len(values), 6):
+        lines.append("    " + ", ".join("%.8ef" % v for v in values[i:i + 6]) + ",")
+    lines.append("};")
+    return "\n".join(lines)
+
+
+def main():
+    out = ["// Generated by DSP_Host/hrtf_gen.py, do not edit",
+           "// Brown-Duda spherical head, %d taps at %d Hz, shuffler form (sum/diff)" % (TAPS, FS),
+           "",
+           '#include "dsp_hrtf.h"',
+           ""]
+    entries = []
+    for name, az in SETS:
+        s, d, itd = make_set(az)
+        ident = "hrtf_" + name
+        out.append("// +-%g deg speakers, ITD %.1f samples" % (az, itd))
+        out.append(c_array(ident + "_sum", s))
+        out.append("")
+        out.append(c_array(ident + "_diff", d))
+        out.append("")
+        entries.append('    { "%s", %s_sum, %s_diff },' % (name, ident, ident))
+    out.append("const dsp_hrtf_set_t dsp_hrtf_sets[DSP_HRTF_SET_COUNT] = {")
+    out.extend(entries)
+    out.append("};")
+    print("\n".join(out))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,369 @@
+// Offline WAV processor: streams a 16-bit WAV file through the firmware DSP
+// chain block by block, exactly as audio_stream.c does on the STM32.
+//
+//   wavproc [options] in.wav out.wav
+//     -b fc,harm,keep,even   enable virtual bass (Hz, dB, %, %)
+//     -w pct[,hpf]           stereo width in % and side high-pass in Hz (0 = off)
+//     -c thr,ratio,knee,att,rel,makeup   enable the compressor (dB, :1, dB, ms, ms, dB)
+//     -a ch,trim,pol,delay   channel alignment (l|r, 0.1 dB, 0|1, us), repeatable
+//     -v set                 headphone virtualiser HRTF set (30deg, 45deg, 60deg)
+//     -e frame,stage,param,value   automation event at an absolute frame (param or 'bypass'), repeatable
+//     -x name                bypass a stage of the default chain
+//     -p                     print per-stage timing (ns) after processing
+
+#include "audio_dsp.h"
+#include "audio_stream.h"
+#include "dsp_pipeline.h"
+#include "perf.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define WAV_FORMAT_PCM         0x0001U
+#define WAV_FORMAT_EXTENSIBLE  0xFFFEU
+#define WAV_HEADER_LEN         44U
+#define WAVPROC_MAX_OPTS       (8U + DSP_AUTO_QUEUE_LEN)
+
+typedef struct {
+    uint32_t fs;
+    uint16_t channels;
+    uint32_t frames;
+} wav_info_t;
+
+static uint16_t rd_u16(const uint8_t* p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t rd_u32(const uint8_t* p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void wr_u16(uint8_t* p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void wr_u32(uint8_t* p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+/**
+ * @brief Parse the RIFF header and leave the file positioned at the first sample
+ * @return 0 on success, -1 if the file is not 16-bit PCM mono/stereo
+ */
+static int wav_read_header(FILE* f, wav_info_t* info)
+{
+    uint8_t hdr[12];
+    uint8_t ck[8];
+    uint8_t fmt[40];
+    bool have_fmt = false;
+
+    if (fread(hdr, 1, sizeof(hdr), f) != sizeof(hdr)
+            || memcmp(hdr, "RIFF", 4) != 0 || memcmp(hdr + 8, "WAVE", 4) != 0) {
+        fprintf(stderr, "not a RIFF/WAVE file\n");
+        return -1;
+    }
+
+    while (fread(ck, 1, sizeof(ck), f) == sizeof(ck)) {
+        uint32_t len = rd_u32(ck + 4);
+        if (memcmp(ck, "fmt ", 4) == 0) {
+            uint32_t n = (len < sizeof(fmt)) ? len : (uint32_t)sizeof(fmt);
+            if (n < 16U || fread(fmt, 1, n, f) != n) {
+                fprintf(stderr, "truncated fmt chunk\n");
+                return -1;
+            }
+            uint16_t tag = rd_u16(fmt);
+            uint16_t bits = rd_u16(fmt + 14);
+            info->channels = rd_u16(fmt + 2);
+            info->fs = rd_u32(fmt + 4);
+            if ((tag != WAV_FORMAT_PCM && tag != WAV_FORMAT_EXTENSIBLE) || bits != 16U
+                    || info->channels < 1U || info->channels > 2U || info->fs == 0U) {
+                fprintf(stderr, "only 16-bit PCM mono/stereo is supported\n");
+                return -1;
+            }
+            have_fmt = true;
+            len -= n;
+        } else if (memcmp(ck, "data", 4) == 0) {
+            if (!have_fmt) {
+                fprintf(stderr, "data chunk before fmt chunk\n");
+                return -1;
+            }
+            info->frames = len / (2U * info->channels);
+            return 0;
+        }
+        // Skip the rest of the chunk (chunks are word aligned)
+        if (fseek(f, (long)(len + (len & 1U)), SEEK_CUR) != 0) {
+            break;
+        }
+    }
+    fprintf(stderr, "no data chunk\n");
+    return -1;
+}
+
+/**
+ * @brief Write a canonical 16-bit stereo PCM header
+ */
+static int wav_write_header(FILE* f, uint32_t fs, uint32_t frames)
+{
+    uint8_t h[WAV_HEADER_LEN];
+    uint32_t data_len = frames * 4U;
+
+    memcpy(h, "RIFF", 4);
+    wr_u32(h + 4, 36U + data_len);
+    memcpy(h + 8, "WAVEfmt ", 8);
+    wr_u32(h + 16, 16U);
+    wr_u16(h + 20, WAV_FORMAT_PCM);
+    wr_u16(h + 22, 2U);
+    wr_u32(h + 24, fs);
+    wr_u32(h + 28, fs * 4U);
+    wr_u16(h + 32, 4U);
+    wr_u16(h + 34, 16U);
+    memcpy(h + 36, "data", 4);
+    wr_u32(h + 40, data_len);
+    return (fwrite(h, 1, sizeof(h), f) == sizeof(h)) ? 0 : -1;
+}
+
+/**
+ * @brief Apply the command line stage settings, picked up by the first block
+ * @return 0 on success, -1 on a malformed option
+ */
+static int apply_option(char opt, const char* arg)
+{
+    if (opt == 'b') {
+        float fc, harm, keep, even;
+        if (sscanf(arg, "%f,%f,%f,%f", &fc, &harm, &keep, &even) != 4) {
+            fprintf(stderr, "-b expects fc,harm,keep,even\n");
+            return -1;
+        }
+        dsp_vbass_t* vb = audio_dsp_vbass();
+        dsp_vbass_set(vb, true, fc, harm, keep / 100.0f, even / 100.0f);
+        dsp_bank_acquire(&vb->bank); // Not streaming yet, adopt it here
+        return 0;
+    }
+    if (opt == 'w') {
+        int pct = 100;
+        int hpf = 0;
+        if (sscanf(arg, "%d,%d", &pct, &hpf) < 1 || pct < 0) {
+            fprintf(stderr, "-w expects pct[,hpf]\n");
+            return -1;
+        }
+        dsp_width_t* w = audio_dsp_width();
+        dsp_width_set(w, (uint16_t)pct, hpf > 0, (float)hpf);
+        dsp_bank_acquire(&w->bank);
+        return 0;
+    }
+    if (opt == 'c') {
+        float thr, ratio, knee, att, rel, makeup;
+        if (sscanf(arg, "%f,%f,%f,%f,%f,%f", &thr, &ratio, &knee, &att, &rel, &makeup) != 6) {
+            fprintf(stderr, "-c expects thr,ratio,knee,att,rel,makeup\n");
+            return -1;
+        }
+        dsp_comp_t* comp = audio_dsp_comp();
+        dsp_comp_set(comp, true, thr, ratio, knee, att, rel, makeup);
+        dsp_bank_acquire(&comp->bank);
+        return 0;
+    }
+    if (opt == 'a') {
+        char ch;
+        int trim, pol, delay;
+        if (sscanf(arg, "%c,%d,%d,%d", &ch, &trim, &pol, &delay) != 4
+                || (ch != 'l' && ch != 'r') || delay < 0) {
+            fprintf(stderr, "-a expects l|r,trim,pol,delay\n");
+            return -1;
+        }
+        dsp_align_t* al = audio_dsp_align();
+        dsp_align_set(al, (ch == 'l') ? 0U : 1U, (int16_t)trim, pol != 0, (uint16_t)delay);
+        dsp_bank_acquire(&al->bank);
+        return 0;
+    }
+    if (opt == 'v') {
+        int8_t set = dsp_hrtf_find(arg);
+        if (set == DSP_HRTF_OFF) {
+            fprintf(stderr, "-v: unknown HRTF set '%s'\n", arg);
+            return -1;
+        }
+        dsp_hrtf_t* hr = audio_dsp_hrtf();
+        dsp_hrtf_set(hr, set);
+        dsp_bank_acquire(&hr->bank);
+        return 0;
+    }
+    if (opt == 'e') {
+        unsigned long frame;
+        char stage_name[16];
+        char param[16];
+        float value;
+        if (sscanf(arg, "%lu,%15[^,],%15[^,],%f", &frame, stage_name, param, &value) != 4) {
+            fprintf(stderr, "-e expects frame,stage,param,value\n");
+            return -1;
+        }
+        int8_t stage = dsp_pipeline_find(stage_name);
+        if (stage < 0) {
+            fprintf(stderr, "-e: no stage '%s'\n", stage_name);
+            return -1;
+        }
+        dsp_auto_event_t ev;
+        ev.frame = (uint32_t)frame;
+        ev.stage = (uint8_t)stage;
+        ev.param = (strcmp(param, "bypass") == 0) ? DSP_AUTO_PARAM_BYPASS : (uint8_t)atoi(param);
+        ev.value = value;
+        if (!dsp_auto_push(&ev)) {
+            fprintf(stderr, "-e: queue full or events out of order\n");
+            return -1;
+        }
+        return 0;
+    }
+    if (opt == 'x') {
+        dsp_chain_t chain;
+        int8_t stage = dsp_pipeline_find(arg);
+        dsp_pipeline_get_chain(&chain);
+        for (uint8_t i = 0; i < chain.count; i++) {
+            if ((int8_t)chain.slots[i].stage == stage) {
+                dsp_pipeline_bypass(i, true);
+                dsp_pipeline_apply_pending();
+                return 0;
+            }
+        }
+        fprintf(stderr, "-x: no stage '%s' in the chain\n", arg);
+        return -1;
+    }
+    return -1;
+}
+
+static void usage(void)
+{
+    fprintf(stderr,
+            "usage: wavproc [-b fc,harm,keep,even] [-w pct[,hpf]] [-c thr,ratio,knee,att,rel,makeup]\n"
+            "               [-a l|r,trim,pol,delay] [-v set] [-e frame,stage,param,value] [-x stage] [-p]\n"
+            "               in.wav out.wav\n");
+}
+
+int main(int argc, char** argv)
+{
+    int16_t in[AUDIO_STREAM_BLOCK_FRAMES * 2U];
+    int16_t out[AUDIO_STREAM_BLOCK_FRAMES * 2U];
+    float blk_l[AUDIO_STREAM_BLOCK_FRAMES];
+    float blk_r[AUDIO_STREAM_BLOCK_FRAMES];
+    const char* opts[WAVPROC_MAX_OPTS][2];
+    uint32_t opt_count = 0;
+    bool report = false;
+    int argi = 1;
+
+    // Collect options first, the chain is created once the sample rate is known
+    while (argi < argc && argv[argi][0] == '-' && argv[argi][1] != '\0') {
+        char opt = argv[argi][1];
+        if (opt == 'p') {
+            report = true;
+            argi++;
+        } else if ((opt == 'b' || opt == 'w' || opt == 'c' || opt == 'a' || opt == 'v' || opt == 'e' || opt == 'x') && argi + 1 < argc && opt_count < WAVPROC_MAX_OPTS) {
+            opts[opt_count][0] = argv[argi];
+            opts[opt_count][1] = argv[argi + 1];
+            opt_count++;
+            argi += 2;
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    if (argc - argi != 2) {
+        usage();
+        return 2;
+    }
+
+    FILE* fin = fopen(argv[argi], "rb");
+    if (!fin) {
+        perror(argv[argi]);
+        return 1;
+    }
+    wav_info_t info = {0};
+    if (wav_read_header(fin, &info) != 0) {
+        fclose(fin);
+        return 1;
+    }
+    FILE* fout = fopen(argv[argi + 1], "wb");
+    if (!fout) {
+        perror(argv[argi + 1]);
+        fclose(fin);
+        return 1;
+    }
+    if (info.fs != AUDIO_STREAM_FS) {
+        fprintf(stderr, "warning: %lu Hz input, the firmware runs at %u Hz\n",
+                (unsigned long)info.fs, (unsigned)AUDIO_STREAM_FS);
+    }
+
+    // Budget in ns per block, same bookkeeping as the target
+    perf_init((uint32_t)(((uint64_t)PERF_CLOCK_HZ * AUDIO_STREAM_BLOCK_FRAMES) / info.fs));
+    audio_dsp_init((float)info.fs);
+    for (uint32_t i = 0; i < opt_count; i++) {
+        if (apply_option(opts[i][0][1], opts[i][1]) != 0) {
+            fclose(fin);
+            fclose(fout);
+            return 2;
+        }
+    }
+
+    if (wav_write_header(fout, info.fs, info.frames) != 0) {
+        perror(argv[argi + 1]);
+        fclose(fin);
+        fclose(fout);
+        return 1;
+    }
+
+    // A partial last block is zero padded and processed whole, only the valid frames are written
+    uint32_t left = info.frames;
+    while (left > 0) {
+        uint32_t n = (left > AUDIO_STREAM_BLOCK_FRAMES) ? AUDIO_STREAM_BLOCK_FRAMES : left;
+        size_t got = fread(in, 2U * info.channels, n, fin);
+        if (got < n) {
+            fprintf(stderr, "warning: input truncated\n");
+            n = (uint32_t)got;
+            left = n;
+        }
+        for (uint32_t i = 0; i < AUDIO_STREAM_BLOCK_FRAMES; i++) {
+            int16_t l = 0;
+            int16_t r = 0;
+            if (i < n) {
+                const uint8_t* p = (const uint8_t*)&in[i * info.channels];
+                l = (int16_t)rd_u16(p);
+                r = (info.channels == 2U) ? (int16_t)rd_u16(p + 2) : l;
+            }
+            blk_l[i] = (float)l * AUDIO_DSP_S16_SCALE;
+            blk_r[i] = (float)r * AUDIO_DSP_S16_SCALE;
+        }
+
+        audio_dsp_process(blk_l, blk_r, AUDIO_STREAM_BLOCK_FRAMES);
+        audio_dsp_to_s16(blk_l, blk_r, out, AUDIO_STREAM_BLOCK_FRAMES);
+
+        for (uint32_t i = 0; i < n; i++) {
+            uint8_t b[4];
+            wr_u16(b, (uint16_t)out[2 * i]);
+            wr_u16(b + 2, (uint16_t)out[2 * i + 1]);
+            fwrite(b, 1, sizeof(b), fout);
+        }
+        left -= n;
+    }
+
+    if (info.frames != 0 && ftell(fout) != (long)(WAV_HEADER_LEN + info.frames * 4U)) {
+        // Input was truncated, fix up the sizes
+        long end = ftell(fout);
+        fseek(fout, 0, SEEK_SET);
+        wav_write_header(fout, info.fs, (uint32_t)((end - (long)WAV_HEADER_LEN) / 4));
+    }
+    fclose(fin);
+    fclose(fout);
+
+    if (report) {
+        perf_report();
+    }
+    if (dsp_auto_queued() > 0 || dsp_auto_rejected() > 0) {
+        fprintf(stderr, "automation: %lu events not reached, %lu rejected\n",
+                (unsigned long)dsp_auto_queued(), (unsigned long)dsp_auto_rejected());
+    }
+    return 0;
+}
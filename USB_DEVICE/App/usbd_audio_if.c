@@ -22,7 +22,7 @@
 #include "usbd_audio_if.h"
 
 /* USER CODE BEGIN INCLUDE */
-
+#include "audio_stream.h"
 /* USER CODE END INCLUDE */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -169,6 +169,7 @@ static int8_t AUDIO_DeInit_FS(uint32_t options)
 {
   /* USER CODE BEGIN 1 */
   UNUSED(options);
+  audio_stream_stop();
   return (USBD_OK);
   /* USER CODE END 1 */
 }
@@ -186,6 +187,7 @@ static int8_t AUDIO_AudioCmd_FS(uint8_t* pbuf, uint32_t size, uint8_t cmd)
   switch(cmd)
   {
     case AUDIO_CMD_START:
+      audio_stream_start();
     break;
 
     case AUDIO_CMD_PLAY:
@@ -232,9 +234,10 @@ static int8_t AUDIO_MuteCtl_FS(uint8_t cmd)
 static int8_t AUDIO_PeriodicTC_FS(uint8_t *pbuf, uint32_t size, uint8_t cmd)
 {
   /* USER CODE BEGIN 5 */
-  UNUSED(pbuf);
-  UNUSED(size);
-  UNUSED(cmd);
+  if (cmd == AUDIO_OUT_TC)
+  {
+    audio_stream_usb_rx(pbuf, size);
+  }
   return (USBD_OK);
   /* USER CODE END 5 */
 }
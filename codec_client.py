@@ -32,3 +32,13 @@ class CodecClient:
         if enable:
             return f"setsurround {onoff} {int(width)}"
         return f"setsurround {onoff}"
+
+    def peq_load(self, count: int):
+        # Followed by the binary payload once the device answers "PEQ READY" (see peq_import.py)
+        return f"peqload {int(count)}"
+
+    def set_spectrum(self, enable: bool, rate_hz: int = 20):
+        if enable:
+            rate_hz = max(1, min(30, int(rate_hz)))
+            return f"spectrum on {rate_hz}"
+        return "spectrum off"
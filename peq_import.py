@@ -0,0 +1,189 @@
+"""AutoEQ / REW "ParametricEQ" import for the MCU EQ cascade.
+
+Parses the common text export
+
+    Preamp: -6.2 dB
+    Filter 1: ON PK Fc 105 Hz Gain -2.3 dB Q 0.70
+    Filter 2: ON LSC Fc 105 Hz Gain 5.5 dB Q 0.71
+
+designs the biquads here (RBJ cookbook) and packs them into the binary
+payload of the 'peqLoad' command, so a whole correction curve goes over the
+9600 baud link in one transaction instead of one shell command per band.
+
+    python peq_import.py ParametricEQ.txt              # print the sections
+    python peq_import.py ParametricEQ.txt --port COM5  # load them into the device
+"""
+
+import argparse
+import math
+import re
+import struct
+import time
+
+FS = 48000
+MAX_SECTIONS = 10          # DSP_PEQ_MAX_SECTIONS
+PREAMP_MIN_DB = -40.0      # DSP_PEQ_PREAMP_MIN_DB
+PREAMP_MAX_DB = 12.0       # DSP_PEQ_PREAMP_MAX_DB
+POLE_MAX = 0.9999          # DSP_PEQ_POLE_MAX
+DEFAULT_Q = 0.7071
+
+_PREAMP_RE = re.compile(r"^\s*Preamp:\s*([-+\d.]+)\s*dB", re.IGNORECASE)
+_FILTER_RE = re.compile(
+    r"^\s*Filter\s*\d*:\s*(ON|OFF)\s+([A-Z]+)(?:\s+\d+\s*dB)?"
+    r"(?:\s+Fc\s+([\d.]+)\s*Hz)?(?:\s+Gain\s+([-+\d.]+)\s*dB)?(?:\s+Q\s+([\d.]+))?",
+    re.IGNORECASE)
+
+# REW / AutoEQ filter type -> design function name
+_TYPES = {
+    "PK": "peak", "PEQ": "peak",
+    "LS": "lowshelf", "LSC": "lowshelf", "LSQ": "lowshelf",
+    "HS": "highshelf", "HSC": "highshelf", "HSQ": "highshelf",
+    "LP": "lowpass", "LPQ": "lowpass",
+    "HP": "highpass", "HPQ": "highpass",
+    "NO": "notch",
+}
+
+
+def parse(text):
+    """Return (preamp_db, [(kind, fc, gain_db, q), ...]) for the enabled filters."""
+    preamp_db = 0.0
+    filters = []
+    for lineno, line in enumerate(text.splitlines(), 1):
+        m = _PREAMP_RE.match(line)
+        if m:
+            preamp_db = float(m.group(1))
+            continue
+        m = _FILTER_RE.match(line)
+        if not m:
+            continue
+        state, ftype, fc, gain, q = m.groups()
+        ftype = ftype.upper()
+        if state.upper() == "OFF" or ftype == "NONE":
+            continue
+        if ftype not in _TYPES:
+            raise ValueError(f"line {lineno}: unsupported filter type {ftype}")
+        if fc is None:
+            raise ValueError(f"line {lineno}: missing Fc")
+        filters.append((_TYPES[ftype], float(fc), float(gain or 0.0), float(q or DEFAULT_Q)))
+    return preamp_db, filters
+
+
+def design(kind, fc, gain_db, q, fs=FS):
+    """Normalized biquad (b0, b1, b2, a1, a2), RBJ Audio EQ Cookbook."""
+    if not 0.0 < fc < fs / 2.0 or q <= 0.0:
+        raise ValueError(f"{kind} Fc {fc} Hz Q {q} out of range")
+    a = 10.0 ** (gain_db / 40.0)
+    w0 = 2.0 * math.pi * fc / fs
+    cw = math.cos(w0)
+    alpha = math.sin(w0) / (2.0 * q)
+
+    if kind == "peak":
+        b = (1.0 + alpha * a, -2.0 * cw, 1.0 - alpha * a)
+        den = (1.0 + alpha / a, -2.0 * cw, 1.0 - alpha / a)
+    elif kind in ("lowshelf", "highshelf"):
+        sa = 2.0 * math.sqrt(a) * alpha
+        sign = 1.0 if kind == "lowshelf" else -1.0
+        b = (a * ((a + 1.0) - sign * (a - 1.0) * cw + sa),
+             sign * 2.0 * a * ((a - 1.0) - sign * (a + 1.0) * cw),
+             a * ((a + 1.0) - sign * (a - 1.0) * cw - sa))
+        den = ((a + 1.0) + sign * (a - 1.0) * cw + sa,
+               -sign * 2.0 * ((a - 1.0) + sign * (a + 1.0) * cw),
+               (a + 1.0) + sign * (a - 1.0) * cw - sa)
+    elif kind == "lowpass":
+        b = ((1.0 - cw) / 2.0, 1.0 - cw, (1.0 - cw) / 2.0)
+        den = (1.0 + alpha, -2.0 * cw, 1.0 - alpha)
+    elif kind == "highpass":
+        b = ((1.0 + cw) / 2.0, -(1.0 + cw), (1.0 + cw) / 2.0)
+        den = (1.0 + alpha, -2.0 * cw, 1.0 - alpha)
+    elif kind == "notch":
+        b = (1.0, -2.0 * cw, 1.0)
+        den = (1.0 + alpha, -2.0 * cw, 1.0 - alpha)
+    else:
+        raise ValueError(f"unknown filter kind {kind}")
+
+    a0 = den[0]
+    return (b[0] / a0, b[1] / a0, b[2] / a0, den[1] / a0, den[2] / a0)
+
+
+def is_stable(c):
+    """Same test as dsp_peq_section_valid() on the device."""
+    a1, a2 = c[3], c[4]
+    return abs(a2) < POLE_MAX * POLE_MAX and abs(a1) < 1.0 + a2
+
+
+def crc16(data):
+    """CRC-16/CCITT (poly 0x1021, init 0xFFFF), as ctrl_crc16() on the device."""
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) & 0xFFFF if crc & 0x8000 else (crc << 1) & 0xFFFF
+    return crc
+
+
+def build_payload(preamp_db, sections):
+    """Binary 'peqLoad' payload: pre-amp dB, 5 floats per section, CRC-16 (all little endian)."""
+    body = struct.pack("<f", preamp_db)
+    for c in sections:
+        body += struct.pack("<5f", *c)
+    return body + struct.pack("<H", crc16(body))
+
+
+def load_file(path, fs=FS):
+    """Parse and design a ParametricEQ file, return (preamp_db, sections)."""
+    with open(path, encoding="utf-8", errors="ignore") as f:
+        preamp_db, filters = parse(f.read())
+    if len(filters) > MAX_SECTIONS:
+        raise ValueError(f"{len(filters)} filters, the device takes at most {MAX_SECTIONS}")
+    if not PREAMP_MIN_DB <= preamp_db <= PREAMP_MAX_DB:
+        raise ValueError(f"pre-amp {preamp_db} dB out of range")
+    sections = [design(*flt, fs=fs) for flt in filters]
+    for i, c in enumerate(sections, 1):
+        if not is_stable(c):
+            raise ValueError(f"filter {i} is unstable")
+    return preamp_db, sections
+
+
+def send(serial_client, preamp_db, sections, timeout=3.0):
+    """Run the 'peqLoad' handshake on an open SerialClient, return the device reply."""
+    serial_client.write_line(f"peqload {len(sections)}")
+    payload = build_payload(preamp_db, sections)
+    deadline = time.time() + timeout
+    sent = False
+    while time.time() < deadline:
+        for line in serial_client.read_lines():
+            line = line.strip()
+            if line.startswith("PEQ READY") and not sent:
+                serial_client.write_bytes(payload)
+                sent = True
+            elif line.startswith("PEQ OK") or line.startswith("ERR"):
+                return line
+        time.sleep(0.02)
+    return "ERR timeout: no reply from device"
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Load an AutoEQ/REW ParametricEQ file into the device EQ")
+    ap.add_argument("file")
+    ap.add_argument("--port", help="serial port, prints the sections only if omitted")
+    ap.add_argument("--baud", type=int, default=9600)
+    ap.add_argument("--fs", type=int, default=FS)
+    args = ap.parse_args()
+
+    preamp_db, sections = load_file(args.file, args.fs)
+    print(f"Preamp {preamp_db:.1f} dB, {len(sections)} sections, {len(build_payload(preamp_db, sections))} bytes")
+    for i, c in enumerate(sections, 1):
+        print(f"  {i:2d}: " + " ".join(f"{v:+.8f}" for v in c))
+
+    if args.port:
+        from serial_client import SerialClient
+        client = SerialClient()
+        client.open(args.port, args.baud)
+        try:
+            print(send(client, preamp_db, sections))
+        finally:
+            client.close()
+
+
+if __name__ == "__main__":
+    main()
@@ -40,6 +40,10 @@ class SerialClient:
             data = (line + self.newline).encode(errors='ignore')
             self.serial_port.write(data)
 
+    def write_bytes(self, data: bytes):
+        if self.is_open():
+            self.serial_port.write(data)
+
     def _reader(self):
         buffer = bytearray()
         while not self.stop_event.is_set():
@@ -60,7 +64,7 @@ class SerialClient:
                 # stop on error
                 break
 
-    def read_line(self):
+    def read_lines(self):
         lines = []
         while True:
             try:
@@ -1,16 +1,24 @@
 import tkinter as tk
-from tkinter import ttk, messagebox
+from tkinter import ttk, messagebox, filedialog
 from serial.tools import list_ports
 
 from codec_client import CodecClient
 from serial_client import SerialClient
+import peq_import
 
 
 class SoundCardApp(tk.Tk):
+    # Spectrum line format: "SPEC " + one char per band, '0' + level (0..63 = -63..0 dBFS)
+    SPEC_BANDS = 16
+    SPEC_LEVEL_MAX = 63
+    SPEC_MIN_HZ = 60.0
+    SPEC_MAX_HZ = 12000.0
+    SPEC_H = 120
+
     def __init__(self):
         super().__init__()
         self.title("Sound Card Controller BUKREK")
-        self.geometry("800x600")
+        self.geometry("800x780")
 
         self.serial = SerialClient()
         self.codec = CodecClient(self.serial)
@@ -73,6 +81,14 @@ class SoundCardApp(tk.Tk):
         self.scale_volume = ttk.Scale(frame_mid, from_=0, to=100, orient="horizontal"); self.scale_volume.set(60)
         self.scale_volume.grid(row=3, column=1, sticky="we", padx=6, columnspan=1)
         ttk.Button(frame_mid, text="Set Volume", command=self.apply_volume).grid(row=3, column=2, padx=6, sticky="w")
+
+        # Headphone correction (AutoEQ / REW ParametricEQ.txt -> MCU EQ cascade)
+        ttk.Label(frame_mid, text="Headphone EQ:").grid(row=4, column=0, sticky="w", padx=6, pady=2)
+        self.peq_file_var = tk.StringVar(value="(none)")
+        ttk.Label(frame_mid, textvariable=self.peq_file_var).grid(row=4, column=1, sticky="w", padx=4, pady=2)
+        ttk.Button(frame_mid, text="Import PEQ...", command=self.import_peq)\
+            .grid(row=4, column=2, padx=6, pady=2, sticky="w")
+        self.peq_payload = None
         # Layout weights for compact alignment
         frame_mid.columnconfigure(0, weight=0)
         frame_mid.columnconfigure(1, weight=1)
@@ -106,6 +122,25 @@ class SoundCardApp(tk.Tk):
             self.update_eq_bar(i, self.eq_vars[i].get())
         ttk.Button(frame_eq, text="Apply EQ", command=self.apply_eq_sliders).grid(row=2, column=0, columnspan=5, pady=6)
 
+        # Spectrum analyser (device streams "SPEC" lines while enabled)
+        frame_spec = ttk.LabelFrame(self, text="Output Spectrum"); frame_spec.pack(fill="x", padx=8, pady=6)
+        spec_ctrl = ttk.Frame(frame_spec); spec_ctrl.pack(fill="x", padx=4, pady=(4,0))
+        self.spec_enable_var = tk.BooleanVar(value=False)
+        ttk.Checkbutton(spec_ctrl, text="Stream spectrum", variable=self.spec_enable_var,
+                        command=self.apply_spectrum).pack(side="left")
+        ttk.Label(spec_ctrl, text="Rate (Hz):").pack(side="left", padx=(12,2))
+        self.entry_spec_rate = ttk.Entry(spec_ctrl, width=4); self.entry_spec_rate.insert(0, "20")
+        self.entry_spec_rate.pack(side="left")
+        self.spec_canvas = tk.Canvas(frame_spec, height=self.SPEC_H + 16, bg="#1e1e1e", highlightthickness=0)
+        self.spec_canvas.pack(fill="x", padx=4, pady=4)
+        self.spec_bars = []
+        for i in range(self.SPEC_BANDS):
+            self.spec_bars.append(self.spec_canvas.create_rectangle(0, 0, 0, 0, fill="#28a745", outline=""))
+            self.spec_canvas.create_text(0, 0, text=self.spec_band_label(i), fill="#c0c0c0",
+                                         font=("Segoe UI", 7), tags=f"label{i}")
+        self.spec_levels = [0] * self.SPEC_BANDS
+        self.spec_canvas.bind("<Configure>", lambda e: self.draw_spectrum())
+
         # Bottom: Console + manual command
         frame_bot = ttk.Frame(self); frame_bot.pack(fill="both", expand=True, padx=8, pady=6)
         self.txt = tk.Text(frame_bot, height=10, wrap="none")
@@ -119,6 +154,29 @@ class SoundCardApp(tk.Tk):
         # Periodic check for received data
         self.after(50, self.drain_serial)
 
+    def spec_band_label(self, idx):
+        ratio = self.SPEC_MAX_HZ / self.SPEC_MIN_HZ
+        hz = self.SPEC_MIN_HZ * ratio ** ((idx + 0.5) / self.SPEC_BANDS)
+        return f"{hz/1000:.1f}k" if hz >= 1000 else f"{hz:.0f}"
+
+    def draw_spectrum(self):
+        c = self.spec_canvas
+        width = max(c.winfo_width(), self.SPEC_BANDS)
+        slot = width / self.SPEC_BANDS
+        for i, level in enumerate(self.spec_levels):
+            x0 = i * slot + 2
+            x1 = (i + 1) * slot - 2
+            top = self.SPEC_H - int(self.SPEC_H * level / self.SPEC_LEVEL_MAX) + 2
+            c.coords(self.spec_bars[i], x0, top, x1, self.SPEC_H + 2)
+            c.coords(f"label{i}", (x0 + x1) / 2, self.SPEC_H + 10)
+
+    def handle_spectrum_line(self, line):
+        payload = line[5:].strip()
+        if len(payload) != self.SPEC_BANDS:
+            return
+        self.spec_levels = [max(0, min(self.SPEC_LEVEL_MAX, ord(ch) - ord("0"))) for ch in payload]
+        self.draw_spectrum()
+
     def update_eq_bar(self, idx, val):
         try:
             val = float(val)
@@ -208,10 +266,39 @@ class SoundCardApp(tk.Tk):
         vol = int(self.scale_volume.get())
         self.send_cmd(self.codec.set_volume(vol))
 
+    def import_peq(self):
+        path = filedialog.askopenfilename(title="ParametricEQ file",
+                                          filetypes=[("Text", "*.txt"), ("All files", "*.*")])
+        if not path:
+            return
+        try:
+            preamp_db, sections = peq_import.load_file(path)
+        except (OSError, ValueError) as e:
+            messagebox.showerror("Error", f"Cannot import {path}: {e}")
+            return
+        self.peq_file_var.set(f"{path.replace(chr(92), '/').split('/')[-1]} ({len(sections)} filters, {preamp_db:.1f} dB)")
+        # Payload goes out when the device answers "PEQ READY"
+        self.peq_payload = peq_import.build_payload(preamp_db, sections)
+        self.send_cmd(self.codec.peq_load(len(sections)))
+
+    def apply_spectrum(self):
+        try:
+            rate = int(self.entry_spec_rate.get())
+        except ValueError:
+            rate = 20
+        self.send_cmd(self.codec.set_spectrum(self.spec_enable_var.get(), rate))
+
     def drain_serial(self):
         try:
             # read_lines() returns a list of lines
             for line in self.serial.read_lines():
+                if line.startswith("SPEC "):
+                    self.handle_spectrum_line(line)
+                    continue
+                if line.startswith("PEQ READY") and self.peq_payload is not None:
+                    self.serial.write_bytes(self.peq_payload)
+                    self.log(f"> ({len(self.peq_payload)} byte PEQ payload)")
+                    self.peq_payload = None
                 self.log(f"< {line.strip()}")
         except Exception:
             pass